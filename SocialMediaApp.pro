@@ -1,6 +1,6 @@
 QT       += core gui widgets
 
-CONFIG   += c++17
+CONFIG   += c++17 thread
 
 TARGET = SocialMediaApp
 TEMPLATE = app
@@ -7,41 +7,204 @@
 #include <limits>
 #include <stdexcept>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <cmath>
+#include <thread>
+#include <bitset>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <new>
+#include <future>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <string_view>
+#include <charconv>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
 
 using namespace std;
 
-// --- Utility: Fixed-size String List for Manual Parsing ---
-class StringList {
+// --- Utility: zero-copy text parsing ---
+// Splits a line into views of its fields; nothing is copied. The vector is
+// reused from line to line, so once it has grown splitting allocates nothing.
+inline void splitFields(string_view line, char delimiter, vector<string_view>& fields) {
+    fields.clear();
+    if (line.empty()) { fields.push_back(line); return; }
+    const char* p = line.data();
+    const char* end = p + line.size();
+    while (const char* d = static_cast<const char*>(memchr(p, delimiter, end - p))) {
+        fields.emplace_back(p, d - p);
+        p = d + 1;
+    }
+    fields.emplace_back(p, end - p);
+}
+
+// Reads a text file in large blocks and hands out its lines as views into
+// the block (valid until the next call). Lines are found with memchr; a
+// line cut by the block end is moved to the front before the next read,
+// and the buffer doubles for a line longer than the whole block.
+class LineReader {
+private:
+    static const size_t BLOCK_BYTES = size_t(1) << 22;
+    FILE* file = nullptr;
+    vector<char> buffer;
+    size_t begin = 0, end = 0;
+    bool atEof = false;
+
+    static string_view trimCR(const char* p, size_t len) {
+        if (len > 0 && p[len - 1] == '\r') --len; // files written on Windows
+        return string_view(p, len);
+    }
+
 public:
-    string data[20];
-    int size = 0;
-};
+    LineReader() = default;
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+    ~LineReader() { close(); }
 
-inline void splitString(const string& str, char delimiter, StringList& result) {
-    result.size = 0;
-    string current;
-    for (char c : str) {
-        if (c == delimiter) {
-            if (result.size < 20) {
-                result.data[result.size++] = current;
+    bool open(const string& path) {
+        close();
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+        buffer.resize(BLOCK_BYTES);
+        return true;
+    }
+
+    void close() {
+        if (file) std::fclose(file);
+        file = nullptr;
+        begin = end = 0;
+        atEof = false;
+    }
+
+    bool next(string_view& line) {
+        if (!file) return false;
+        while (true) {
+            const char* start = buffer.data() + begin;
+            if (begin < end) {
+                const char* nl = static_cast<const char*>(memchr(start, '\n', end - begin));
+                if (nl) {
+                    begin += (nl - start) + 1;
+                    line = trimCR(start, nl - start);
+                    return true;
+                }
             }
-            current = "";
-        }
-        else {
-            current += c;
+            if (atEof) {
+                if (begin == end) return false;
+                line = trimCR(start, end - begin); // last line without '\n'
+                begin = end;
+                return true;
+            }
+            size_t rest = end - begin;
+            if (rest > 0 && begin > 0) memmove(buffer.data(), start, rest);
+            begin = 0;
+            end = rest;
+            if (end == buffer.size()) buffer.resize(buffer.size() * 2);
+            size_t n = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+            end += n;
+            if (n == 0) atEof = true;
         }
     }
-    if (result.size < 20) {
-        result.data[result.size++] = current;
+};
+
+// Decimal field to int; false if it isn't one
+inline bool parseInt(string_view text, int& out) {
+    const char* last = text.data() + text.size();
+    auto r = from_chars(text.data(), last, out);
+    return r.ec == errc() && r.ptr == last;
+}
+
+// --- Utility: data-parallel loops over std::thread ---
+// Number of chunks worth spawning for n items when each thread should get at
+// least minPerThread of them. 1 means "run inline".
+inline size_t parallelChunks(size_t n, size_t minPerThread) {
+    size_t hw = thread::hardware_concurrency();
+    if (hw == 0) hw = 1;
+    size_t byWork = minPerThread ? n / minPerThread : n;
+    if (byWork < 1) byWork = 1;
+    return byWork < hw ? byWork : hw;
+}
+
+// Runs fn(begin, end, chunk) over `chunks` contiguous slices of [0, n).
+template <typename F>
+void parallelFor(size_t n, size_t chunks, F fn) {
+    if (chunks <= 1 || n < 2) { fn(size_t(0), n, size_t(0)); return; }
+    size_t step = (n + chunks - 1) / chunks;
+    vector<thread> workers;
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t begin = c * step;
+        size_t end = begin + step < n ? begin + step : n;
+        if (begin >= end) break;
+        workers.emplace_back(fn, begin, end, c);
+    }
+    for (thread& t : workers) t.join();
+}
+
+// 64-bit FNV-1a followed by a murmur-style finalizer so that the low bits
+// used for slot selection depend on every input byte.
+inline uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t hash64(const string& str) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : str) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
     }
+    return mix64(hash);
 }
 
-inline unsigned int simple_hash(const string& str) {
-    unsigned int hash = 5381;
-    for (char c : str) {
-        hash = ((hash << 5) + hash) + c;
+inline uint64_t hash64(uint64_t key) { return mix64(key + 0x9e3779b97f4a7c15ULL); }
+
+// xorshift64 generator, small enough to keep one per worker thread
+class XorShift64 {
+private:
+    uint64_t state;
+public:
+    explicit XorShift64(uint64_t seed) : state(mix64(seed) | 1) {}
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+    // Uniform in [0, 1), from the top 53 bits
+    double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+
+// Numeric part of a prefixed ID ("P105" -> 105). Returns 0 when malformed.
+inline long long idNumber(const string& idStr) {
+    if (idStr.size() < 2) return 0;
+    long long n = 0;
+    for (size_t i = 1; i < idStr.size(); ++i) {
+        if (idStr[i] < '0' || idStr[i] > '9') return 0;
+        n = n * 10 + (idStr[i] - '0');
     }
-    return hash % 100; // HASHTABLE_CAPACITY = 100
+    return n;
 }
 
 
@@ -53,21 +216,26 @@ public:
     string password;
 
     User(string id = "", string u = "", string p = "")
-        : userID(id), username(u), password(p) {
+        : userID(std::move(id)), username(std::move(u)), password(std::move(p)) {
     }
 
     string toString() const {
         return userID + "|" + username + "|" + password;
     }
 
-    static User fromString(const string& line) {
-        StringList parts;
-        splitString(line, '|', parts);
-        if (parts.size >= 3) {
-            return User(parts.data[0], parts.data[1], parts.data[2]);
+    // One allocation per stored field; `parts` is scratch the caller can
+    // reuse across lines
+    static User fromString(string_view line, vector<string_view>& parts) {
+        splitFields(line, '|', parts);
+        if (parts.size() >= 3) {
+            return User(string(parts[0]), string(parts[1]), string(parts[2]));
         }
         return User();
     }
+    static User fromString(string_view line) {
+        vector<string_view> parts;
+        return fromString(line, parts);
+    }
 };
 
 class Comment {
@@ -76,23 +244,34 @@ public:
     string postID;
     string authorUsername;
     string content;
+    string parentCommentID; // empty for top-level comments
 
-    Comment(string cid = "", string pid = "", string author = "", string c = "")
-        : commentID(cid), postID(pid), authorUsername(author), content(c) {
+    Comment(string cid = "", string pid = "", string author = "", string c = "", string parent = "")
+        : commentID(std::move(cid)), postID(std::move(pid)), authorUsername(std::move(author)),
+          content(std::move(c)), parentCommentID(std::move(parent)) {
     }
 
+    bool isReply() const { return !parentCommentID.empty(); }
+
+    // The parent is an optional 5th field, so older files still load
     string toString() const {
-        return commentID + "|" + postID + "|" + authorUsername + "|" + content;
+        string line = commentID + "|" + postID + "|" + authorUsername + "|" + content;
+        if (isReply()) line += "|" + parentCommentID;
+        return line;
     }
 
-    static Comment fromString(const string& line) {
-        StringList parts;
-        splitString(line, '|', parts);
-        if (parts.size >= 4) {
-            return Comment(parts.data[0], parts.data[1], parts.data[2], parts.data[3]);
+    static Comment fromString(string_view line, vector<string_view>& parts) {
+        splitFields(line, '|', parts);
+        if (parts.size() >= 4) {
+            return Comment(string(parts[0]), string(parts[1]), string(parts[2]), string(parts[3]),
+                           parts.size() >= 5 ? string(parts[4]) : string());
         }
         return Comment();
     }
+    static Comment fromString(string_view line) {
+        vector<string_view> parts;
+        return fromString(line, parts);
+    }
 };
 
 class Post {
@@ -102,661 +281,3481 @@ public:
     string content;
 
     Post(string pid = "", string author = "", string c = "")
-        : postID(pid), authorUsername(author), content(c) {
+        : postID(std::move(pid)), authorUsername(std::move(author)), content(std::move(c)) {
     }
 
+    // Posts order by numeric ID so "P100" sorts after "P99"
+    long long number() const { return idNumber(postID); }
     bool operator<(const Post& other) const {
-        return postID < other.postID;
+        return number() < other.number();
     }
     bool operator>(const Post& other) const {
-        return postID > other.postID;
+        return number() > other.number();
     }
     bool operator<=(const Post& other) const {
-        return postID <= other.postID;
+        return number() <= other.number();
     }
 
     string toString(int likes = 0) const {
         return postID + "|" + authorUsername + "|" + content + "|" + to_string(likes);
     }
 
-    static Post fromString(const string& line, int* outLikes = nullptr) {
-        StringList parts;
-        splitString(line, '|', parts);
-        if (parts.size >= 3) {
+    static Post fromString(string_view line, vector<string_view>& parts, int* outLikes = nullptr) {
+        splitFields(line, '|', parts);
+        if (parts.size() >= 3) {
             int likes = 0;
-            if (parts.size >= 4) {
-                try { likes = stoi(parts.data[3]); } catch(...) { likes = 0; }
-            }
+            if (parts.size() >= 4 && !parseInt(parts[3], likes)) likes = 0;
             if (outLikes) *outLikes = likes;
-            return Post(parts.data[0], parts.data[1], parts.data[2]);
+            return Post(string(parts[0]), string(parts[1]), string(parts[2]));
         }
         return Post();
     }
+    static Post fromString(string_view line, int* outLikes = nullptr) {
+        vector<string_view> parts;
+        return fromString(line, parts, outLikes);
+    }
 };
 
 
 // --- DATA STRUCTURES ---
-class PostNode {
-public:
-    Post data;
-    PostNode* next;
-    PostNode(const Post& val) : data(val), next(nullptr) {}
-};
 
-class CommentNode {
-public:
-    Comment data;
-    CommentNode* next;
-    CommentNode(const Comment& val) : data(val), next(nullptr) {}
-};
+// Slot addressing shared by the chunked logs below. With chunks of
+// first, 2*first, 4*first, ... records, chunk c holds slots
+// [first * (2^c - 1), first * (2^(c+1) - 1)).
+inline size_t doublingChunkOf(size_t slot, size_t first, size_t& offset) {
+    size_t v = slot / first + 1;
+    size_t c = 0;
+    while (v >>= 1) ++c;
+    offset = slot - first * ((size_t(1) << c) - 1);
+    return c;
+}
 
-class StringNode {
-public:
-    string data;
-    StringNode* next;
-    StringNode(const string& val) : data(val), next(nullptr) {}
-};
+// Per-user post storage: an append-only log split into chunks that double
+// in size (16, 32, 64, ... posts). Appends are O(1), records never move
+// until compact(), and iteration walks contiguous arrays instead of chasing
+// one heap pointer per post. remove() leaves a tombstone; once tombstones
+// outnumber live posts the log compacts itself.
+class PostLog {
+private:
+    static const size_t FIRST_CHUNK = 16;
+    vector<Post*> chunks;
+    vector<uint8_t> live; // one flag per slot
+    size_t used = 0;      // slots handed out, live or not
+    size_t liveCount = 0;
+    bool ascending = true;
 
+    static size_t locate(size_t slot, size_t& offset) { return doublingChunkOf(slot, FIRST_CHUNK, offset); }
 
-// Singly Linked List (Posts)
-class SinglyLinkedList_Post {
-private:
-    PostNode* head;
-public:
-    SinglyLinkedList_Post() : head(nullptr) {}
-    ~SinglyLinkedList_Post() {
-        PostNode* current = head;
-        while (current) {
-            PostNode* next = current->next;
-            delete current;
-            current = next;
-        }
-        head = nullptr;
-    }
-    void insertAtEnd(const Post& val) {
-        PostNode* newNode = new PostNode(val);
-        if (!head) {
-            head = newNode;
-            return;
-        }
-        PostNode* current = head;
-        while (current->next) current = current->next;
-        current->next = newNode;
+    // Any handed-out slot, tombstones included (they keep their record)
+    const Post& record(size_t slot) const {
+        size_t offset;
+        size_t c = locate(slot, offset);
+        return chunks[c][offset];
     }
-    PostNode* getHead() const { return head; }
 
-    vector<Post> toVector() const {
-        vector<Post> out;
-        PostNode* cur = head;
-        while (cur) { out.push_back(cur->data); cur = cur->next; }
-        return out;
+    void release() {
+        for (Post* chunk : chunks) delete[] chunk;
+        chunks.clear();
+        live.clear();
+        used = liveCount = 0;
+        ascending = true;
     }
 
-    bool removeByPostID(const string& pid) {
-        PostNode* cur = head;
-        PostNode* prev = nullptr;
-        while (cur) {
-            if (cur->data.postID == pid) {
-                if (!prev) {
-                    head = cur->next;
-                } else {
-                    prev->next = cur->next;
-                }
-                delete cur;
-                return true;
-            }
-            prev = cur;
-            cur = cur->next;
-        }
+public:
+    PostLog() {}
+    PostLog(const PostLog&) = delete;
+    PostLog& operator=(const PostLog&) = delete;
+    PostLog(PostLog&& other) noexcept
+        : chunks(std::move(other.chunks)), live(std::move(other.live)), used(other.used),
+          liveCount(other.liveCount), ascending(other.ascending) {
+        other.chunks.clear();
+        other.used = other.liveCount = 0;
+    }
+    PostLog& operator=(PostLog&& other) noexcept {
+        std::swap(chunks, other.chunks);
+        std::swap(live, other.live);
+        std::swap(used, other.used);
+        std::swap(liveCount, other.liveCount);
+        std::swap(ascending, other.ascending);
+        return *this;
+    }
+    ~PostLog() { release(); }
+
+    // Returns the slot of the new record. Taken by value so a parsed
+    // record can be moved in.
+    size_t append(Post val) {
+        size_t offset;
+        size_t c = locate(used, offset);
+        if (c == chunks.size()) chunks.push_back(new Post[FIRST_CHUNK << c]);
+        // Tombstones count too: newestSlotBelow() searches every slot
+        if (used > 0 && val < record(used - 1)) ascending = false;
+        chunks[c][offset] = std::move(val);
+        live.push_back(1);
+        ++liveCount;
+        return used++;
+    }
+
+    // nullptr for tombstones and out-of-range slots
+    Post* at(size_t slot) const {
+        if (slot >= used || !live[slot]) return nullptr;
+        size_t offset;
+        size_t c = locate(slot, offset);
+        return &chunks[c][offset];
+    }
+
+    // Tombstones the slot in O(1). Returns true if this triggered a
+    // compaction, which renumbers slots and moves records.
+    bool remove(size_t slot) {
+        if (!at(slot)) return false;
+        live[slot] = 0;
+        --liveCount;
+        size_t dead = used - liveCount;
+        if (dead > 32 && dead > liveCount) { compact(); return true; }
         return false;
     }
 
-    bool editByPostID(const string& pid, const string& newContent) {
-        PostNode* cur = head;
-        while (cur) {
-            if (cur->data.postID == pid) {
-                cur->data.content = newContent;
-                return true;
-            }
-            cur = cur->next;
+    // Rewrites the live records into fresh chunks in ascending ID order.
+    void compact() {
+        vector<Post> kept;
+        kept.reserve(liveCount);
+        for (size_t i = 0; i < used; ++i) if (live[i]) kept.push_back(std::move(*at(i)));
+        if (!ascending) sort(kept.begin(), kept.end());
+        release();
+        for (Post& p : kept) append(std::move(p));
+    }
+
+    bool isSorted() const { return ascending; }
+    size_t size() const { return liveCount; }
+    bool isEmpty() const { return liveCount == 0; }
+    size_t slotCount() const { return used; }
+
+    // Newest-first iteration over live slots; -1 when exhausted
+    long long newestSlot() const { return previousSlot(static_cast<long long>(used)); }
+    long long previousSlot(long long slot) const {
+        for (long long i = slot - 1; i >= 0; --i) if (live[i]) return i;
+        return -1;
+    }
+
+    // Newest live slot whose post number is below `bound`, or -1. A log in
+    // ID order is binary-searched; the scan is only a fallback.
+    long long newestSlotBelow(long long bound) const {
+        if (!ascending) {
+            long long slot = newestSlot();
+            while (slot >= 0 && at(slot)->number() >= bound) slot = previousSlot(slot);
+            return slot;
         }
-        return false;
+        size_t lo = 0, hi = used; // first slot numbered >= bound
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (record(mid).number() < bound) lo = mid + 1;
+            else hi = mid;
+        }
+        return previousSlot(static_cast<long long>(lo));
     }
-};
 
-// Hash Node
-template <typename K, typename V>
-class HashNode {
-public:
-    K key;
-    V value;
-    HashNode<K, V>* next;
-    HashNode(const K& k, const V& v) : key(k), value(v), next(nullptr) {}
+    // Visits live records as fn(slot, post), newest first
+    template <typename F>
+    void forEach(F fn) const {
+        for (long long i = newestSlot(); i >= 0; i = previousSlot(i)) fn(static_cast<size_t>(i), *at(i));
+    }
+
+    // NEWEST first
+    vector<Post> toVector() const {
+        vector<Post> out;
+        out.reserve(liveCount);
+        forEach([&](size_t, const Post& p) { out.push_back(p); });
+        return out;
+    }
 };
 
-// Simple Hash Table
-const int HASHTABLE_CAPACITY = 100;
+// Robin Hood open-addressing hash table.
+// Entries live in one flat array next to a compact metadata array holding the
+// probe distance and a hash tag, so a lookup scans a few contiguous 8-byte
+// words before it ever compares a key. The table doubles once the load factor
+// is exceeded. Note: pointers returned by search() are invalidated by any
+// insert() that grows the table and by remove().
+// The entry array is raw storage: only occupied slots hold a constructed
+// entry, so an empty slot never builds a V (which may own memory itself).
 template <typename K, typename V>
 class SimpleHashTable {
 private:
-    HashNode<K, V>** table;
-public:
-    SimpleHashTable() { table = new HashNode<K, V>*[HASHTABLE_CAPACITY](); }
-    ~SimpleHashTable() {
-        for (int i = 0; i < HASHTABLE_CAPACITY; ++i) {
-            HashNode<K, V>* current = table[i];
-            while (current) {
-                HashNode<K, V>* temp = current;
-                current = current->next;
-                delete temp;
-            }
-        }
-        delete[] table;
-    }
-    void insert(const K& key, const V& value) {
-        unsigned int index = simple_hash(key);
-        HashNode<K, V>* current = table[index];
-        while (current) {
-            if (current->key == key) {
-                current->value = value;
+    class Entry {
+    public:
+        K key;
+        V value;
+    };
+    class Meta {
+    public:
+        uint32_t dist; // 0 = empty, otherwise probe distance + 1
+        uint32_t tag;  // upper hash bits, compared before the key
+    };
+    Entry* entries = nullptr; // constructed where meta[i].dist != 0
+    vector<Meta> meta;
+    size_t count = 0;
+    size_t mask = 0;
+    float maxLoadFactor;
+
+    static uint32_t tagOf(uint64_t h) { return static_cast<uint32_t>(h >> 32); }
+
+    long long findSlot(const K& key) const {
+        if (count == 0) return -1;
+        uint64_t h = hash64(key);
+        uint32_t tag = tagOf(h);
+        size_t idx = h & mask;
+        for (uint32_t d = 1; ; ++d) {
+            const Meta& m = meta[idx];
+            // Robin Hood invariant: once we pass a poorer slot the key is absent
+            if (m.dist < d) return -1;
+            if (m.dist == d && m.tag == tag && entries[idx].key == key) return static_cast<long long>(idx);
+            idx = (idx + 1) & mask;
+        }
+    }
+
+    void placeNew(Entry&& entry, uint64_t h) {
+        Meta cur{1, tagOf(h)};
+        size_t idx = h & mask;
+        while (true) {
+            Meta& m = meta[idx];
+            if (m.dist == 0) {
+                m = cur;
+                new (&entries[idx]) Entry(std::move(entry));
+                ++count;
                 return;
             }
-            current = current->next;
+            if (m.dist < cur.dist) {
+                // Steal from the rich: the resident is closer to home than we are
+                std::swap(m, cur);
+                std::swap(entries[idx], entry);
+            }
+            ++cur.dist;
+            idx = (idx + 1) & mask;
         }
-        HashNode<K, V>* newNode = new HashNode<K, V>(key, value);
-        newNode->next = table[index];
-        table[index] = newNode;
     }
-    V* search(const K& key) const {
-        unsigned int index = simple_hash(key);
-        HashNode<K, V>* current = table[index];
-        while (current) {
-            if (current->key == key) return &(current->value);
-            current = current->next;
+
+    static Entry* allocate(size_t n) { return allocator<Entry>().allocate(n); }
+
+    // Destroys the occupied entries of an array laid out by `m`, then frees it
+    static void release(Entry* e, const vector<Meta>& m) {
+        if (!e) return;
+        for (size_t i = 0; i < m.size(); ++i) if (m[i].dist) e[i].~Entry();
+        allocator<Entry>().deallocate(e, m.size());
+    }
+
+    void rehash(size_t newCapacity) {
+        Entry* oldEntries = entries;
+        vector<Meta> oldMeta = std::move(meta);
+        entries = allocate(newCapacity);
+        meta = vector<Meta>(newCapacity, Meta{0, 0});
+        mask = newCapacity - 1;
+        count = 0;
+        for (size_t i = 0; i < oldMeta.size(); ++i) {
+            if (oldMeta[i].dist) placeNew(std::move(oldEntries[i]), hash64(oldEntries[i].key));
         }
-        return nullptr;
+        release(oldEntries, oldMeta);
     }
-    HashNode<K, V>** getTable() const { return table; }
-};
 
-// SimpleQueue for comments
-class SimpleQueue_Comment {
-private:
-    CommentNode* front;
-    CommentNode* rear;
-public:
-    SimpleQueue_Comment() : front(nullptr), rear(nullptr) {}
-    ~SimpleQueue_Comment() {
-        CommentNode* current = front;
-        while (current) {
-            CommentNode* next = current->next;
-            delete current;
-            current = next;
-        }
-        front = rear = nullptr;
-    }
-    void enqueue(const Comment& val) {
-        CommentNode* newNode = new CommentNode(val);
-        if (!rear) { front = rear = newNode; }
-        else { rear->next = newNode; rear = newNode; }
-    }
-    bool isEmpty() const { return front == nullptr; }
-    CommentNode* getFront() const { return front; }
-    vector<Comment> toVector() const {
-        vector<Comment> out;
-        CommentNode* cur = front;
-        while (cur) { out.push_back(cur->data); cur = cur->next; }
-        return out;
+    static size_t roundUpPow2(size_t n) {
+        size_t cap = 16;
+        while (cap < n) cap <<= 1;
+        return cap;
     }
-};
 
-// SimpleQueue for strings
-class SimpleQueue_String {
-private:
-    StringNode* front;
-    StringNode* rear;
-public:
-    SimpleQueue_String() : front(nullptr), rear(nullptr) {}
-    ~SimpleQueue_String() {
-        StringNode* current = front;
-        while (current) { StringNode* next = current->next; delete current; current = next; }
-        front = rear = nullptr;
-    }
-    void enqueue(const string& val) {
-        StringNode* newNode = new StringNode(val);
-        if (!rear) { front = rear = newNode; }
-        else { rear->next = newNode; rear = newNode; }
-    }
-    string dequeue() {
-        if (isEmpty()) throw runtime_error("Dequeue from empty queue");
-        StringNode* temp = front;
-        string data = front->data;
-        front = front->next;
-        if (!front) rear = nullptr;
-        delete temp;
-        return data;
-    }
-    bool isEmpty() const { return front == nullptr; }
-    StringNode* getFront() const { return front; }
-};
-
-// SimpleStack for likes
-class SimpleStack_String {
-private:
-    StringNode* top;
 public:
-    SimpleStack_String() : top(nullptr) {}
-    ~SimpleStack_String() {
-        while (top) { StringNode* temp = top; top = top->next; delete temp; }
+    explicit SimpleHashTable(size_t initialCapacity = 16, float loadFactor = 0.85f)
+        : maxLoadFactor(loadFactor) {
+        size_t cap = roundUpPow2(initialCapacity);
+        entries = allocate(cap);
+        meta = vector<Meta>(cap, Meta{0, 0});
+        mask = cap - 1;
     }
-    void push(const string& val) {
-        StringNode* newNode = new StringNode(val); newNode->next = top; top = newNode;
+    SimpleHashTable(const SimpleHashTable& other)
+        : meta(other.meta), count(other.count), mask(other.mask), maxLoadFactor(other.maxLoadFactor) {
+        entries = allocate(meta.size());
+        for (size_t i = 0; i < meta.size(); ++i) {
+            if (meta[i].dist) new (&entries[i]) Entry(other.entries[i]);
+        }
     }
-    string pop() {
-        if (isEmpty()) throw runtime_error("Pop from empty stack");
-        StringNode* temp = top;
-        string d = top->data;
-        top = top->next;
-        delete temp;
-        return d;
+    // A moved-from table is empty with no storage; the next insert allocates
+    SimpleHashTable(SimpleHashTable&& other) noexcept
+        : entries(other.entries), meta(std::move(other.meta)), count(other.count),
+          mask(other.mask), maxLoadFactor(other.maxLoadFactor) {
+        other.entries = nullptr;
+        other.meta.clear();
+        other.count = 0;
+        other.mask = 0;
     }
-    string peek() const {
-        if (isEmpty()) throw runtime_error("Peek from empty stack");
-        return top->data;
+    SimpleHashTable& operator=(SimpleHashTable other) noexcept {
+        std::swap(entries, other.entries);
+        std::swap(meta, other.meta);
+        std::swap(count, other.count);
+        std::swap(mask, other.mask);
+        std::swap(maxLoadFactor, other.maxLoadFactor);
+        return *this;
     }
-    bool isEmpty() const { return top == nullptr; }
+    ~SimpleHashTable() { release(entries, meta); }
 
-    vector<string> toVector() const {
-        vector<string> out;
-        StringNode* cur = top;
-        while (cur) { out.push_back(cur->data); cur = cur->next; }
-        return out;
+    // Inserts or overwrites the value stored under key.
+    void insert(const K& key, V value) {
+        long long found = findSlot(key);
+        if (found >= 0) { entries[found].value = std::move(value); return; }
+        if (static_cast<float>(count + 1) > maxLoadFactor * static_cast<float>(meta.size())) rehash(meta.empty() ? 16 : meta.size() * 2);
+        placeNew(Entry{key, std::move(value)}, hash64(key));
     }
-    int count() const {
-        int c = 0; StringNode* cur = top;
-        while (cur) { ++c; cur = cur->next; }
-        return c;
+
+    V* search(const K& key) const {
+        long long found = findSlot(key);
+        if (found < 0) return nullptr;
+        return const_cast<V*>(&entries[found].value);
     }
-    bool contains(const string& s) const {
-        StringNode* cur = top;
-        while (cur) { if (cur->data == s) return true; cur = cur->next; }
-        return false;
+
+    // Backward-shift deletion keeps probe sequences tombstone-free.
+    bool remove(const K& key) {
+        long long found = findSlot(key);
+        if (found < 0) return false;
+        size_t idx = static_cast<size_t>(found);
+        size_t next = (idx + 1) & mask;
+        while (meta[next].dist > 1) {
+            meta[idx] = Meta{meta[next].dist - 1, meta[next].tag};
+            entries[idx] = std::move(entries[next]);
+            idx = next;
+            next = (next + 1) & mask;
+        }
+        meta[idx] = Meta{0, 0};
+        entries[idx].~Entry();
+        --count;
+        return true;
     }
-    bool remove(const string& s) {
-        StringNode* cur = top;
-        StringNode* prev = nullptr;
-        while (cur) {
-            if (cur->data == s) {
-                if (!prev) top = cur->next;
-                else prev->next = cur->next;
-                delete cur;
-                return true;
-            }
-            prev = cur;
-            cur = cur->next;
+
+    void clear() {
+        for (size_t i = 0; i < meta.size(); ++i) {
+            if (meta[i].dist) { meta[i] = Meta{0, 0}; entries[i].~Entry(); }
         }
-        return false;
+        count = 0;
     }
-};
 
-// Graph adjacency list
-class LinkNode {
-public:
-    string username;
-    LinkNode* next;
-    LinkNode(const string& uname) : username(uname), next(nullptr) {}
-};
+    // Grows the table so that n entries fit without further rehashing.
+    void reserve(size_t n) {
+        size_t needed = roundUpPow2(static_cast<size_t>(static_cast<float>(n) / maxLoadFactor) + 1);
+        if (needed > meta.size()) rehash(needed);
+    }
 
-class AdjacencyList {
-public:
-    string username;
-    LinkNode* head;
-    AdjacencyList(const string& uname = "") : username(uname), head(nullptr) {}
-    ~AdjacencyList() {
-        LinkNode* current = head;
-        while (current) { LinkNode* next = current->next; delete current; current = next; }
-        head = nullptr;
-    }
-    void addFriend(const string& friendUsername) {
-        LinkNode* cur = head;
-        while (cur) { if (cur->username == friendUsername) return; cur = cur->next; }
-        LinkNode* newNode = new LinkNode(friendUsername);
-        newNode->next = head; head = newNode;
-    }
-    void removeFriend(const string& friendUsername) {
-        LinkNode* cur = head;
-        LinkNode* prev = nullptr;
-        while (cur) {
-            if (cur->username == friendUsername) {
-                if (!prev) head = cur->next;
-                else prev->next = cur->next;
-                delete cur;
-                return;
-            }
-            prev = cur;
-            cur = cur->next;
+    void setMaxLoadFactor(float loadFactor) {
+        if (loadFactor < 0.1f) loadFactor = 0.1f;
+        if (loadFactor > 0.95f) loadFactor = 0.95f;
+        maxLoadFactor = loadFactor;
+        reserve(count);
+    }
+
+    size_t size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    size_t capacity() const { return meta.size(); }
+
+    // Visits every live entry as fn(key, value), in slot order.
+    template <typename F>
+    void forEach(F fn) {
+        for (size_t i = 0; i < meta.size(); ++i) {
+            if (meta[i].dist) fn(entries[i].key, entries[i].value);
+        }
+    }
+    template <typename F>
+    void forEach(F fn) const {
+        for (size_t i = 0; i < meta.size(); ++i) {
+            if (meta[i].dist) fn(static_cast<const K&>(entries[i].key), static_cast<const V&>(entries[i].value));
         }
     }
-    LinkNode* getHead() const { return head; }
 };
 
-class Graph {
+// Per-post comment storage: append-only, oldest first, in chunks that
+// double in size like PostLog. The count is stored, and a range read jumps
+// straight to its first chunk, so reading one page of a long thread touches
+// only the comments on that page.
+// Threading is an index on top of the log: the top-level comments in order,
+// plus a child list for each comment that has replies. Expanding a thread
+// reads just that comment's children; reply counts are the list sizes.
+class CommentLog {
 private:
-    SimpleHashTable<string, AdjacencyList> nodes;
+    static const size_t FIRST_CHUNK = 8;
+    vector<Comment*> chunks;
+    size_t count = 0;
+    vector<uint32_t> topLevel;
+    // parent index -> child indices; allocated on the first reply
+    unique_ptr<SimpleHashTable<uint64_t, vector<uint32_t>>> replies;
+
+    const vector<uint32_t>* childrenOf(size_t index) const {
+        return replies ? replies->search(static_cast<uint64_t>(index)) : nullptr;
+    }
+
+    template <typename F>
+    void forEachIndexed(const vector<uint32_t>& indices, size_t offset, size_t limit, F fn) const {
+        for (size_t i = offset; i < indices.size() && i - offset < limit; ++i) fn(*at(indices[i]));
+    }
+
+    static size_t locate(size_t index, size_t& offset) { return doublingChunkOf(index, FIRST_CHUNK, offset); }
+
 public:
-    void addNode(const string& username) {
-        if (!nodes.search(username)) nodes.insert(username, AdjacencyList(username));
+    CommentLog() {}
+    CommentLog(const CommentLog&) = delete;
+    CommentLog& operator=(const CommentLog&) = delete;
+    CommentLog(CommentLog&& other) noexcept
+        : chunks(std::move(other.chunks)), count(other.count), topLevel(std::move(other.topLevel)),
+          replies(std::move(other.replies)) {
+        other.chunks.clear();
+        other.count = 0;
     }
-    void addEdge(const string& u1, const string& u2) {
-        AdjacencyList* list1 = nodes.search(u1);
-        AdjacencyList* list2 = nodes.search(u2);
-        if (list1 && list2) {
-            list1->addFriend(u2);
-            list2->addFriend(u1);
-        }
+    CommentLog& operator=(CommentLog&& other) noexcept {
+        std::swap(chunks, other.chunks);
+        std::swap(count, other.count);
+        std::swap(topLevel, other.topLevel);
+        std::swap(replies, other.replies);
+        return *this;
     }
-    void removeEdge(const string& u1, const string& u2) {
-        AdjacencyList* list1 = nodes.search(u1);
-        AdjacencyList* list2 = nodes.search(u2);
-        if (list1) list1->removeFriend(u2);
-        if (list2) list2->removeFriend(u1);
+    ~CommentLog() {
+        for (Comment* chunk : chunks) delete[] chunk;
     }
-    bool isFriend(const string& u1, const string& u2) const {
-        AdjacencyList* list1 = nodes.search(u1);
-        if (!list1) return false;
-        LinkNode* cur = list1->head;
-        while (cur) {
-            if (cur->username == u2) return true;
-            cur = cur->next;
+
+    // Returns the index of the new comment. parentIndex < 0 (or out of
+    // range) files it as a top-level comment.
+    size_t append(Comment val, long long parentIndex = -1) {
+        size_t offset;
+        size_t c = locate(count, offset);
+        if (c == chunks.size()) chunks.push_back(new Comment[FIRST_CHUNK << c]);
+        chunks[c][offset] = std::move(val);
+        uint32_t index = static_cast<uint32_t>(count);
+        if (parentIndex < 0 || static_cast<size_t>(parentIndex) >= count) {
+            topLevel.push_back(index);
+        } else {
+            if (!replies) replies.reset(new SimpleHashTable<uint64_t, vector<uint32_t>>(4));
+            vector<uint32_t>* children = replies->search(static_cast<uint64_t>(parentIndex));
+            if (!children) {
+                replies->insert(static_cast<uint64_t>(parentIndex), vector<uint32_t>());
+                children = replies->search(static_cast<uint64_t>(parentIndex));
+            }
+            children->push_back(index);
         }
-        return false;
+        return count++;
     }
-    vector<string> getFriends(const string& u) const {
-        vector<string> f;
-        AdjacencyList* list = nodes.search(u);
-        if (list) {
-            LinkNode* cur = list->head;
-            while(cur) { f.push_back(cur->username); cur = cur->next; }
-        }
-        return f;
+
+    const Comment* at(size_t index) const {
+        if (index >= count) return nullptr;
+        size_t offset;
+        size_t c = locate(index, offset);
+        return &chunks[c][offset];
     }
-    vector<string> suggestFriends(const string& startUsername) const {
-        vector<string> result;
-        SimpleQueue_String levelQueue;
-        SimpleHashTable<string, bool> visited;
-        levelQueue.enqueue(startUsername);
-        visited.insert(startUsername, true);
-        int level = 0;
-        while (!levelQueue.isEmpty()) {
-            int levelSize = 0;
-            StringNode* tempNode = levelQueue.getFront();
-            while (tempNode) { levelSize++; tempNode = tempNode->next; }
-            while (levelSize-- > 0) {
-                try {
-                    string u = levelQueue.dequeue();
-                    AdjacencyList* adjList = nodes.search(u);
-                    if (adjList) {
-                        LinkNode* currentFriend = adjList->head;
-                        while (currentFriend) {
-                            string v = currentFriend->username;
-                            if (!visited.search(v)) {
-                                visited.insert(v, true);
-                                levelQueue.enqueue(v);
-                                if (level == 1) result.push_back(v);
-                            }
-                            currentFriend = currentFriend->next;
-                        }
-                    }
-                } catch(...) {}
-            }
-            level++;
-            if (level > 1) break;
+
+    size_t size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+
+    // Visits comments [offset, offset + limit) oldest first
+    template <typename F>
+    void forEachInRange(size_t offset, size_t limit, F fn) const {
+        if (offset >= count) return;
+        size_t end = (limit < count - offset) ? offset + limit : count;
+        size_t pos;
+        size_t c = locate(offset, pos);
+        for (size_t i = offset; i < end; ++c, pos = 0) {
+            size_t chunkSize = FIRST_CHUNK << c;
+            for (; pos < chunkSize && i < end; ++pos, ++i) fn(chunks[c][pos]);
         }
-        return result;
     }
-    SimpleHashTable<string, AdjacencyList>* getNodesTable() { return &nodes; }
-};
 
-// BST templated
-template <typename T>
-class BSTNode {
-public:
-    T data;
-    BSTNode<T>* left;
-    BSTNode<T>* right;
-    BSTNode(const T& val) : data(val), left(nullptr), right(nullptr) {}
-};
+    template <typename F>
+    void forEach(F fn) const { forEachInRange(0, count, fn); }
 
-template <typename T>
-class BinarySearchTree {
-private:
-    BSTNode<T>* root;
-    BSTNode<T>* insertRecursive(BSTNode<T>* node, const T& val) {
-        if (!node) return new BSTNode<T>(val);
-        if (val < node->data) node->left = insertRecursive(node->left, val);
-        else node->right = insertRecursive(node->right, val); // Modified: Allow duplicates/equality to go Right
-        return node;
-    }
-    void inOrderRecursive(BSTNode<T>* node, vector<T>& out) const {
-        if (!node) return;
-        inOrderRecursive(node->left, out);
-        out.push_back(node->data);
-        inOrderRecursive(node->right, out);
-    }
-    // New Helper: Traverse Right (Larger/Newer) then Left (Smaller/Older)
-    void reverseInOrderRecursive(BSTNode<T>* node, vector<T>& out) const {
-        if (!node) return;
-        reverseInOrderRecursive(node->right, out); // Visit larger/newer first
-        out.push_back(node->data);
-        reverseInOrderRecursive(node->left, out);
-    }
-
-    void deleteRecursive(BSTNode<T>* node) {
-        if (!node) return;
-        deleteRecursive(node->left);
-        deleteRecursive(node->right);
-        delete node;
+    size_t topLevelCount() const { return topLevel.size(); }
+    size_t replyCount(size_t index) const {
+        const vector<uint32_t>* children = childrenOf(index);
+        return children ? children->size() : 0;
     }
-public:
-    BinarySearchTree() : root(nullptr) {}
-    ~BinarySearchTree() { deleteRecursive(root); }
-    void clear() { deleteRecursive(root); root = nullptr; }
-    void insert(const T& val) { root = insertRecursive(root, val); }
-    vector<T> toVectorInOrder() const {
-        vector<T> out;
-        inOrderRecursive(root, out);
+
+    vector<Comment> topLevelRange(size_t offset, size_t limit) const {
+        vector<Comment> out;
+        forEachIndexed(topLevel, offset, limit, [&](const Comment& c) { out.push_back(c); });
         return out;
     }
-    // Function to get posts from Newest to Oldest (assuming ID increases with time)
-    vector<T> toVectorReverseInOrder() const {
-        vector<T> out;
-        reverseInOrderRecursive(root, out);
+
+    // Direct replies to the comment at `index`, oldest first
+    vector<Comment> repliesRange(size_t index, size_t offset, size_t limit) const {
+        vector<Comment> out;
+        const vector<uint32_t>* children = childrenOf(index);
+        if (children) forEachIndexed(*children, offset, limit, [&](const Comment& c) { out.push_back(c); });
+        return out;
+    }
+
+    vector<Comment> range(size_t offset, size_t limit) const {
+        vector<Comment> out;
+        if (offset < count) out.reserve(min(limit, count - offset));
+        forEachInRange(offset, limit, [&](const Comment& c) { out.push_back(c); });
         return out;
     }
 };
 
-// --- SOCIAL MEDIA SYSTEM ---
-class SocialMediaSystem {
-private:
-    SimpleHashTable<string, User> userHash;
-    SimpleHashTable<string, SinglyLinkedList_Post> userPosts;
-    SimpleHashTable<string, SimpleQueue_Comment> postComments;
-    SimpleHashTable<string, SimpleStack_String> postLikes;
-    Graph friendGraph;
-    BinarySearchTree<Post> allPostsBST;
+inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    return static_cast<int>(bitset<64>(x).count());
+#endif
+}
 
-    User* currentUser = nullptr;
+// Leading zero bits of x (64 for 0)
+inline int leadingZeros64(uint64_t x) {
+    if (x == 0) return 64;
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & (uint64_t(1) << 63))) { x <<= 1; ++n; }
+    return n;
+#endif
+}
 
-    // ID Tracking to prevent duplicates across sessions
-    int maxUserID = 0;
-    int maxPostID = 99; // Starts at 100
-    int maxCommentID = 999; // Starts at 1000
+// Compressed bitmap over 32-bit IDs (Roaring layout). IDs are bucketed by
+// their high 16 bits; a bucket holds a sorted array of low halves while
+// sparse and switches to a 65536-bit bitmap once it passes ARRAY_MAX.
+// Intersections of two bitmap buckets are a word-wise AND + popcount.
+class RoaringBitmap {
+private:
+    static const size_t ARRAY_MAX = 4096;
+    static const size_t BITMAP_WORDS = 1024;
 
-    const string USERS_FILE = "users.txt";
-    const string POSTS_FILE = "posts.txt";
-    const string COMMENTS_FILE = "comments.txt";
-    const string FRIENDS_FILE = "friends.txt";
+    class Container {
+    public:
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+        vector<uint16_t> values;  // sorted; used while the bucket is sparse
+        vector<uint64_t> words;   // non-empty once the bucket is dense
+        bool isBitmap() const { return !words.empty(); }
+    };
+    vector<Container> containers;  // sorted by key
+    size_t total = 0;
 
-    // Helper to extract numeric part from ID (e.g., P105 -> 105)
-    int extractID(const string& idStr, char prefix) const {
-        if (idStr.size() < 2 || idStr[0] != prefix) return 0;
-        try { return stoi(idStr.substr(1)); } catch(...) { return 0; }
+    size_t lowerBound(uint16_t key) const {
+        size_t lo = 0, hi = containers.size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (containers[mid].key < key) lo = mid + 1; else hi = mid;
+        }
+        return lo;
     }
 
-    string generateUserID() { return "U" + to_string(++maxUserID); }
-    string generatePostID() { return "P" + to_string(++maxPostID); }
-    string generateCommentID() { return "C" + to_string(++maxCommentID); }
+    static void toBitmap(Container& c) {
+        c.words.assign(BITMAP_WORDS, 0);
+        for (uint16_t v : c.values) c.words[v >> 6] |= uint64_t(1) << (v & 63);
+        vector<uint16_t>().swap(c.values);
+    }
 
-    void loadDataInternal() {
-        ifstream userFile(USERS_FILE);
-        string line;
-        while (getline(userFile, line)) {
-            User u = User::fromString(line);
-            if (!u.username.empty()) {
-                userHash.insert(u.username, u);
-                friendGraph.addNode(u.username);
-                // Update Max ID
-                int idNum = extractID(u.userID, 'U');
-                if (idNum > maxUserID) maxUserID = idNum;
-            }
+    static void toArray(Container& c) {
+        c.values.clear();
+        c.values.reserve(c.cardinality);
+        for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+            uint64_t bits = c.words[w];
+            for (int b = 0; b < 64; ++b)
+                if (bits & (uint64_t(1) << b)) c.values.push_back(static_cast<uint16_t>(w * 64 + b));
         }
-        userFile.close();
-
-        ifstream postFile(POSTS_FILE);
-        while (getline(postFile, line)) {
-            int likesFromFile = 0;
-            Post p = Post::fromString(line, &likesFromFile);
-            if (!p.postID.empty()) {
-                // Update Max ID
-                int idNum = extractID(p.postID, 'P');
-                if (idNum > maxPostID) maxPostID = idNum;
+        vector<uint64_t>().swap(c.words);
+    }
 
-                SinglyLinkedList_Post* postsList = userPosts.search(p.authorUsername);
-                if (!postsList) { userPosts.insert(p.authorUsername, SinglyLinkedList_Post()); postsList = userPosts.search(p.authorUsername); }
-                postsList->insertAtEnd(p);
-                allPostsBST.insert(p); // BST now allows duplicates
-                postComments.insert(p.postID, SimpleQueue_Comment());
-                SimpleStack_String likesStack;
-                for (int i = 0; i < likesFromFile; ++i) likesStack.push("L" + to_string(i));
-                postLikes.insert(p.postID, likesStack);
-            }
+    static size_t andCardinality(const Container& a, const Container& b) {
+        if (a.isBitmap() && b.isBitmap()) {
+            size_t n = 0;
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) n += popcount64(a.words[w] & b.words[w]);
+            return n;
         }
-        postFile.close();
+        if (a.isBitmap() || b.isBitmap()) {
+            const Container& arr = a.isBitmap() ? b : a;
+            const Container& bmp = a.isBitmap() ? a : b;
+            size_t n = 0;
+            for (uint16_t v : arr.values) n += (bmp.words[v >> 6] >> (v & 63)) & 1;
+            return n;
+        }
+        size_t n = 0, i = 0, j = 0;
+        while (i < a.values.size() && j < b.values.size()) {
+            if (a.values[i] < b.values[j]) ++i;
+            else if (b.values[j] < a.values[i]) ++j;
+            else { ++n; ++i; ++j; }
+        }
+        return n;
+    }
 
-        ifstream commentFile(COMMENTS_FILE);
-        while (getline(commentFile, line)) {
-            Comment c = Comment::fromString(line);
-            if (!c.commentID.empty()) {
-                // Update Max ID
-                int idNum = extractID(c.commentID, 'C');
-                if (idNum > maxCommentID) maxCommentID = idNum;
+public:
+    bool contains(uint32_t id) const {
+        uint16_t key = static_cast<uint16_t>(id >> 16), low = static_cast<uint16_t>(id & 0xFFFF);
+        size_t i = lowerBound(key);
+        if (i == containers.size() || containers[i].key != key) return false;
+        const Container& c = containers[i];
+        if (c.isBitmap()) return (c.words[low >> 6] >> (low & 63)) & 1;
+        return binary_search(c.values.begin(), c.values.end(), low);
+    }
 
-                SimpleQueue_Comment* q = postComments.search(c.postID);
-                if (q) q->enqueue(c);
-            }
+    // Returns false if the ID was already present
+    bool add(uint32_t id) {
+        uint16_t key = static_cast<uint16_t>(id >> 16), low = static_cast<uint16_t>(id & 0xFFFF);
+        size_t i = lowerBound(key);
+        if (i == containers.size() || containers[i].key != key) {
+            Container c;
+            c.key = key;
+            containers.insert(containers.begin() + i, std::move(c));
         }
-        commentFile.close();
-
-        ifstream friendFile(FRIENDS_FILE);
-        while (getline(friendFile, line)) {
-            StringList parts;
-            splitString(line, '|', parts);
-            if (parts.size >= 2) { friendGraph.addEdge(parts.data[0], parts.data[1]); }
+        Container& c = containers[i];
+        if (c.isBitmap()) {
+            uint64_t& word = c.words[low >> 6];
+            uint64_t bit = uint64_t(1) << (low & 63);
+            if (word & bit) return false;
+            word |= bit;
+        } else {
+            auto it = lower_bound(c.values.begin(), c.values.end(), low);
+            if (it != c.values.end() && *it == low) return false;
+            c.values.insert(it, low);
+            if (c.values.size() > ARRAY_MAX) toBitmap(c);
         }
-        friendFile.close();
+        ++c.cardinality;
+        ++total;
+        return true;
     }
 
-    void rebuildAllPostsBST() {
-        allPostsBST.clear();
-        SimpleHashTable<string, SinglyLinkedList_Post>* mup = const_cast<SimpleHashTable<string, SinglyLinkedList_Post>*>(&userPosts);
-        HashNode<string, SinglyLinkedList_Post>** pt = mup->getTable();
-        for (int i = 0; i < HASHTABLE_CAPACITY; ++i) {
-            HashNode<string, SinglyLinkedList_Post>* cur = pt[i];
-            while (cur) {
-                PostNode* pn = cur->value.getHead();
-                while (pn) {
-                    allPostsBST.insert(pn->data);
-                    pn = pn->next;
-                }
-                cur = cur->next;
-            }
+    // Returns false if the ID was not present
+    bool remove(uint32_t id) {
+        uint16_t key = static_cast<uint16_t>(id >> 16), low = static_cast<uint16_t>(id & 0xFFFF);
+        size_t i = lowerBound(key);
+        if (i == containers.size() || containers[i].key != key) return false;
+        Container& c = containers[i];
+        if (c.isBitmap()) {
+            uint64_t& word = c.words[low >> 6];
+            uint64_t bit = uint64_t(1) << (low & 63);
+            if (!(word & bit)) return false;
+            word &= ~bit;
+            // Demote well below ARRAY_MAX so a bucket near the edge doesn't flip-flop
+            if (c.cardinality - 1 <= ARRAY_MAX / 2) toArray(c);
+        } else {
+            auto it = lower_bound(c.values.begin(), c.values.end(), low);
+            if (it == c.values.end() || *it != low) return false;
+            c.values.erase(it);
         }
+        --total;
+        if (--c.cardinality == 0) containers.erase(containers.begin() + i);
+        return true;
     }
 
-public:
-    SocialMediaSystem() { loadDataInternal(); }
-    ~SocialMediaSystem() { saveData(); }
-
-    void saveData() const {
-        ofstream userFile(USERS_FILE);
-        SimpleHashTable<string, User>* muh = const_cast<SimpleHashTable<string, User>*>(&userHash);
-        HashNode<string, User>** ut = muh->getTable();
-        for (int i = 0; i < HASHTABLE_CAPACITY; ++i) {
-            HashNode<string, User>* cur = ut[i];
-            while (cur) { userFile << cur->value.toString() << "\n"; cur = cur->next; }
-        }
-        userFile.close();
+    size_t cardinality() const { return total; }
+    bool isEmpty() const { return total == 0; }
 
-        ofstream postFile(POSTS_FILE);
-        SimpleHashTable<string, SinglyLinkedList_Post>* mup = const_cast<SimpleHashTable<string, SinglyLinkedList_Post>*>(&userPosts);
-        HashNode<string, SinglyLinkedList_Post>** pt = mup->getTable();
-        for (int i = 0; i < HASHTABLE_CAPACITY; ++i) {
-            HashNode<string, SinglyLinkedList_Post>* cur = pt[i];
-            while (cur) {
-                PostNode* pn = cur->value.getHead();
-                while (pn) {
-                    SimpleStack_String* s = const_cast<SimpleHashTable<string, SimpleStack_String>*>(&postLikes)->search(pn->data.postID);
-                    int likesCount = s ? s->count() : 0;
-                    postFile << pn->data.toString(likesCount) << "\n";
-                    pn = pn->next;
-                }
-                cur = cur->next;
-            }
+    // |this AND other| without materialising the intersection
+    size_t andCardinality(const RoaringBitmap& other) const {
+        size_t n = 0, i = 0, j = 0;
+        while (i < containers.size() && j < other.containers.size()) {
+            if (containers[i].key < other.containers[j].key) ++i;
+            else if (other.containers[j].key < containers[i].key) ++j;
+            else { n += andCardinality(containers[i], other.containers[j]); ++i; ++j; }
         }
-        postFile.close();
+        return n;
+    }
 
-        ofstream commentFile(COMMENTS_FILE);
-        SimpleHashTable<string, SimpleQueue_Comment>* mpc = const_cast<SimpleHashTable<string, SimpleQueue_Comment>*>(&postComments);
-        HashNode<string, SimpleQueue_Comment>** ct = mpc->getTable();
-        for (int i = 0; i < HASHTABLE_CAPACITY; ++i) {
-            HashNode<string, SimpleQueue_Comment>* cur = ct[i];
-            while (cur) {
-                CommentNode* cn = cur->value.getFront();
-                while (cn) { commentFile << cn->data.toString() << "\n"; cn = cn->next; }
-                cur = cur->next;
+    // Visits IDs in ascending order
+    template <typename F>
+    void forEach(F fn) const {
+        for (const Container& c : containers) {
+            uint32_t high = uint32_t(c.key) << 16;
+            if (!c.isBitmap()) {
+                for (uint16_t v : c.values) fn(high | v);
+                continue;
             }
-        }
-        commentFile.close();
-
-        ofstream friendFile(FRIENDS_FILE);
-        SimpleHashTable<string, bool> savedPairs;
-        HashNode<string, AdjacencyList>** ft = const_cast<Graph*>(&friendGraph)->getNodesTable()->getTable();
-        for (int i = 0; i < HASHTABLE_CAPACITY; ++i) {
-            HashNode<string, AdjacencyList>* cur = ft[i];
-            while (cur) {
-                string u1 = cur->value.username;
-                LinkNode* f = cur->value.head;
-                while (f) {
-                    string u2 = f->username;
-                    string key = (u1 < u2) ? (u1 + "_" + u2) : (u2 + "_" + u1);
-                    if (!savedPairs.search(key)) { friendFile << u1 << "|" << u2 << "\n"; savedPairs.insert(key, true); }
-                    f = f->next;
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+                uint64_t bits = c.words[w];
+                while (bits) {
+                    int b = popcount64((bits & (~bits + 1)) - 1);  // index of lowest set bit
+                    fn(high | static_cast<uint32_t>(w * 64 + b));
+                    bits &= bits - 1;
                 }
-                cur = cur->next;
             }
         }
-        friendFile.close();
     }
+};
 
-    bool userRegistration(const string& username, const string& password) {
-        if (userHash.search(username)) return false;
-        string newID = generateUserID();
-        userHash.insert(username, User(newID, username, password));
-        friendGraph.addNode(username);
+// Liker set for one post, keyed by the dense user IDs handed out by Graph.
+// Count is the bitmap cardinality; anonymousLikes holds likes imported from
+// files that stored only a count.
+class LikerSet {
+private:
+    RoaringBitmap likers;
+    int anonymousLikes = 0;
+public:
+    LikerSet() {}
+    explicit LikerSet(int legacyCount) : anonymousLikes(legacyCount > 0 ? legacyCount : 0) {}
+
+    bool contains(uint32_t userId) const { return likers.contains(userId); }
+
+    // Returns true if the user now likes the post
+    bool toggle(uint32_t userId) {
+        if (likers.remove(userId)) return false;
+        likers.add(userId);
         return true;
     }
-    bool userLogin(const string& username, const string& password) {
-        User* u = userHash.search(username);
+
+    // Named liker read back from disk; it was already part of the legacy count
+    void addLoaded(uint32_t userId) {
+        if (!likers.add(userId)) return;
+        if (anonymousLikes > 0) --anonymousLikes;
+    }
+
+    int count() const { return static_cast<int>(likers.cardinality()) + anonymousLikes; }
+
+    // How many members of `users` liked the post
+    int countAmong(const RoaringBitmap& users) const { return static_cast<int>(likers.andCardinality(users)); }
+
+    template <typename F>
+    void forEach(F fn) const { likers.forEach(fn); }
+};
+
+// Like toggles are buffered until the window elapses or the batch fills,
+// then applied to the liker sets in one pass
+const int LIKE_FLUSH_WINDOW_MS = 250;
+const size_t LIKE_BATCH_SIZE = 512;
+
+// Buffered toggles for one post. Toggling twice nets out, so `toggled` holds
+// exactly the users whose like flips at flush; delta is the count change.
+class PendingLikes {
+public:
+    RoaringBitmap toggled;
+    int delta = 0;
+};
+
+class LikeBatcher {
+private:
+    SimpleHashTable<string, PendingLikes> pending;
+    size_t bufferedToggles = 0;
+    size_t maxBatch;
+    chrono::milliseconds window;
+    chrono::steady_clock::time_point windowStart;
+public:
+    LikeBatcher(size_t maxBatchSize = LIKE_BATCH_SIZE, int windowMs = LIKE_FLUSH_WINDOW_MS)
+        : maxBatch(maxBatchSize), window(windowMs) {}
+
+    // nowLiked is the user's effective state after this toggle
+    void record(const string& postID, uint32_t userId, bool nowLiked) {
+        if (pending.isEmpty()) windowStart = chrono::steady_clock::now();
+        PendingLikes* p = pending.search(postID);
+        if (!p) {
+            pending.insert(postID, PendingLikes());
+            p = pending.search(postID);
+        }
+        if (!p->toggled.remove(userId)) p->toggled.add(userId);
+        p->delta += nowLiked ? 1 : -1;
+        ++bufferedToggles;
+    }
+
+    const PendingLikes* find(const string& postID) const { return pending.search(postID); }
+    void drop(const string& postID) { pending.remove(postID); }
+
+    bool isEmpty() const { return pending.isEmpty(); }
+    size_t size() const { return bufferedToggles; }
+    bool isFull() const { return bufferedToggles >= maxBatch; }
+    bool windowElapsed() const {
+        return !pending.isEmpty() && chrono::steady_clock::now() - windowStart >= window;
+    }
+
+    // Hands every buffered post to fn(postID, pending) and empties the buffer
+    template <typename F>
+    void drain(F fn) {
+        pending.forEach([&](const string& postID, const PendingLikes& p) { fn(postID, p); });
+        pending.clear();
+        bufferedToggles = 0;
+    }
+};
+
+// Compressed sparse row view of the friend graph over dense user IDs:
+// row u is neighbours[offsets[u] .. offsets[u+1]), sorted ascending.
+// Edge changes since the last build sit in a small overlay (added rows and
+// removed-edge marks) and are folded in by compact() once the overlay grows
+// past an eighth of the snapshot, so patching stays amortised O(1). This is
+// the only copy of the friend graph.
+class CsrGraph {
+private:
+    vector<uint32_t> offsets{0};
+    vector<uint32_t> neighbours;
+    SimpleHashTable<uint64_t, vector<uint32_t>> addedEdges{4}; // node -> neighbours since build
+    SimpleHashTable<uint64_t, uint32_t> addedAt{4};             // (u << 32 | v) -> position in u's added row
+    SimpleHashTable<uint64_t, bool> removedEdges{4};            // (u << 32 | v) removed from rows
+    size_t overlaySize = 0;
+    vector<uint32_t> degrees; // current degree by node, so degree() is O(1)
+
+    static uint64_t edgeKey(uint32_t u, uint32_t v) { return (uint64_t(u) << 32) | v; }
+
+    bool inRow(uint32_t u, uint32_t v) const {
+        if (u + 1 >= offsets.size()) return false;
+        return binary_search(neighbours.begin() + offsets[u], neighbours.begin() + offsets[u + 1], v);
+    }
+
+    void addDirected(uint32_t u, uint32_t v) {
+        if (u >= degrees.size()) degrees.resize(u + 1, 0);
+        ++degrees[u];
+        if (removedEdges.remove(edgeKey(u, v))) { --overlaySize; return; }
+        vector<uint32_t>* added = addedEdges.search(u);
+        if (!added) {
+            addedEdges.insert(u, vector<uint32_t>());
+            added = addedEdges.search(u);
+        }
+        addedAt.insert(edgeKey(u, v), static_cast<uint32_t>(added->size()));
+        added->push_back(v);
+        ++overlaySize;
+    }
+
+    void removeDirected(uint32_t u, uint32_t v) {
+        --degrees[u];
+        uint32_t* pos = addedAt.search(edgeKey(u, v));
+        if (pos) {
+            // Swap-remove from u's added row, re-pointing the moved entry
+            vector<uint32_t>& added = *addedEdges.search(u);
+            uint32_t i = *pos;
+            addedAt.remove(edgeKey(u, v));
+            if (i + 1 != added.size()) {
+                added[i] = added.back();
+                *addedAt.search(edgeKey(u, added[i])) = i;
+            }
+            added.pop_back();
+            --overlaySize;
+            return;
+        }
+        removedEdges.insert(edgeKey(u, v), true);
+        ++overlaySize;
+    }
+
+public:
+    // rowOf(u, out) appends node u's neighbours to out
+    template <typename RowFn>
+    void rebuild(size_t nodeCount, RowFn rowOf) {
+        offsets.assign(1, 0);
+        offsets.reserve(nodeCount + 1);
+        neighbours.clear();
+        for (size_t u = 0; u < nodeCount; ++u) {
+            size_t start = neighbours.size();
+            rowOf(static_cast<uint32_t>(u), neighbours);
+            sort(neighbours.begin() + start, neighbours.end());
+            offsets.push_back(static_cast<uint32_t>(neighbours.size()));
+        }
+        degrees.resize(nodeCount);
+        for (size_t u = 0; u < nodeCount; ++u) degrees[u] = offsets[u + 1] - offsets[u];
+        addedEdges.clear();
+        addedAt.clear();
+        removedEdges.clear();
+        overlaySize = 0;
+    }
+
+    // Rewrites the rows with the overlay folded in; nodeCount may exceed
+    // the rows built so far
+    void compact(size_t nodeCount) {
+        vector<uint32_t> rowStarts{0};
+        rowStarts.reserve(nodeCount + 1);
+        vector<uint32_t> rows;
+        rows.reserve(neighbours.size() + overlaySize);
+        for (size_t u = 0; u < nodeCount; ++u) {
+            size_t start = rows.size();
+            forEachNeighbour(static_cast<uint32_t>(u), [&](uint32_t v) { rows.push_back(v); });
+            sort(rows.begin() + start, rows.end());
+            rowStarts.push_back(static_cast<uint32_t>(rows.size()));
+        }
+        offsets.swap(rowStarts);
+        neighbours.swap(rows);
+        degrees.resize(nodeCount);
+        addedEdges.clear();
+        addedAt.clear();
+        removedEdges.clear();
+        overlaySize = 0;
+    }
+
+    // Callers guarantee the edge is absent (resp. present) before patching
+    void addEdge(uint32_t u, uint32_t v) { addDirected(u, v); addDirected(v, u); }
+    void removeEdge(uint32_t u, uint32_t v) { removeDirected(u, v); removeDirected(v, u); }
+
+    bool needsRebuild() const { return overlaySize > 64 && overlaySize > neighbours.size() / 8; }
+
+    bool hasEdge(uint32_t u, uint32_t v) const {
+        if (addedAt.search(edgeKey(u, v))) return true;
+        return inRow(u, v) && (removedEdges.isEmpty() || !removedEdges.search(edgeKey(u, v)));
+    }
+
+    // Visits u's current neighbours: the snapshot row, then overlay additions
+    template <typename F>
+    void forEachNeighbour(uint32_t u, F fn) const {
+        if (u + 1 < offsets.size()) {
+            bool filter = !removedEdges.isEmpty();
+            for (uint32_t i = offsets[u]; i < offsets[u + 1]; ++i) {
+                uint32_t v = neighbours[i];
+                if (filter && removedEdges.search(edgeKey(u, v))) continue;
+                fn(v);
+            }
+        }
+        vector<uint32_t>* added = addedEdges.search(u);
+        if (added) for (uint32_t v : *added) fn(v);
+    }
+
+    size_t degree(uint32_t u) const { return u < degrees.size() ? degrees[u] : 0; }
+
+    // A uniformly random current neighbour of u; false if u has none.
+    // Snapshot edges marked removed are rejected and redrawn, which the
+    // overlay bound keeps rare; after a few misses fall back to a row copy.
+    bool randomNeighbour(uint32_t u, XorShift64& rng, uint32_t& out) const {
+        size_t rowLen = u + 1 < offsets.size() ? offsets[u + 1] - offsets[u] : 0;
+        vector<uint32_t>* added = addedEdges.search(u);
+        size_t total = rowLen + (added ? added->size() : 0);
+        if (total == 0) return false;
+        bool filter = !removedEdges.isEmpty();
+        for (int attempt = 0; attempt < 8; ++attempt) {
+            size_t i = rng.next() % total;
+            if (i >= rowLen) { out = (*added)[i - rowLen]; return true; }
+            uint32_t v = neighbours[offsets[u] + i];
+            if (filter && removedEdges.search(edgeKey(u, v))) continue;
+            out = v;
+            return true;
+        }
+        vector<uint32_t> row;
+        forEachNeighbour(u, [&](uint32_t v) { row.push_back(v); });
+        if (row.empty()) return false;
+        out = row[rng.next() % row.size()];
+        return true;
+    }
+
+    // u's neighbours in ascending order; a straight row copy unless the
+    // overlay touches u
+    void sortedNeighbours(uint32_t u, vector<uint32_t>& out) const {
+        out.clear();
+        forEachNeighbour(u, [&](uint32_t v) { out.push_back(v); });
+        if (addedEdges.search(u)) sort(out.begin(), out.end());
+    }
+};
+
+// |a AND b| for ascending ranges. A much shorter side gallops through the
+// longer one (exponential probe, then binary search), so a small row
+// against a hub's row costs O(m log(n/m)) rather than O(m + n).
+inline size_t sortedIntersectionCount(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+    const vector<uint32_t>& small = a.size() <= b.size() ? a : b;
+    const vector<uint32_t>& large = a.size() <= b.size() ? b : a;
+    size_t n = 0;
+    if (small.size() * 16 < large.size()) {
+        size_t lo = 0;
+        for (uint32_t v : small) {
+            size_t step = 1, hi = lo;
+            while (hi < large.size() && large[hi] < v) { lo = hi + 1; hi += step; step <<= 1; }
+            if (hi > large.size()) hi = large.size();
+            lo = lower_bound(large.begin() + lo, large.begin() + hi, v) - large.begin();
+            if (lo == large.size()) break;
+            if (large[lo] == v) { ++n; ++lo; }
+        }
+        return n;
+    }
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) ++i;
+        else if (b[j] < a[i]) ++j;
+        else { ++n; ++i; ++j; }
+    }
+    return n;
+}
+
+const size_t SUGGESTION_LIMIT = 20;
+
+// Connection queries give up beyond this many hops
+const int SEPARATION_MAX_DEPTH = 6;
+// BFS frontiers at least this large are expanded on several threads
+const size_t PARALLEL_BFS_THRESHOLD = 50000;
+
+// Visited set over dense user IDs, one bit per user
+class IdBitset {
+private:
+    vector<uint64_t> words;
+public:
+    explicit IdBitset(size_t n) : words((n + 63) / 64, 0) {}
+    bool test(uint32_t id) const { return (words[id >> 6] >> (id & 63)) & 1; }
+    void set(uint32_t id) { words[id >> 6] |= uint64_t(1) << (id & 63); }
+};
+
+enum class SuggestionScore { MutualFriends, AdamicAdar };
+
+class FriendSuggestion {
+public:
+    string username;
+    int mutualFriends = 0;
+    double score = 0.0; // mutual count, the Adamic-Adar sum, or a visit share
+};
+
+// Random-walk recommendations (personalised PageRank): walks per query,
+// chance of jumping back to the source before each step, and a hard cap
+// on walk length
+const size_t PPR_WALK_BUDGET = 20000;
+const double PPR_RESTART_PROBABILITY = 0.15;
+const size_t PPR_MAX_WALK_LENGTH = 32;
+// A query's walks are split across threads only beyond this many per thread
+const size_t PPR_WALKS_PER_THREAD = 5000;
+
+class RandomWalkConfig {
+public:
+    size_t walks = PPR_WALK_BUDGET; // bounds the work, and so the latency
+    double restartProbability = PPR_RESTART_PROBABILITY;
+    size_t maxWalkLength = PPR_MAX_WALK_LENGTH;
+    uint64_t seed = 0;
+};
+
+// Friend-of-friend cache limits: candidates kept per user, and the degree
+// above which an account counts as a hub (see FofCandidates)
+const size_t FOF_CANDIDATE_CAP = 2048;
+const size_t FOF_HUB_DEGREE = 1000;
+
+// Second-degree candidate counts: count(u, w) = friends u and w share.
+// w may itself be a friend of u; reads filter those out, and keeping them
+// makes an unfriend restore the right count. Hubs are left out of the
+// counts, since every pair of their friends would become candidates;
+// readers walk hub rows directly instead.
+// A user's table is built by the first read that needs it (see
+// Graph::candidatesOf) and from then on kept up to date on every edge
+// change; users nobody has read cost nothing, so bulk loads skip the
+// pair counting entirely.
+// A table holds at most `cap` candidates, the best-connected ones: a newcomer
+// to a full table evicts the candidate with the fewest shared friends if it
+// has more, and the table is marked truncated. No candidate left out of a
+// truncated table shares more friends than its weakest entry, so top-k
+// reads still come from it when the k-th pick beats that entry; reads that
+// need every candidate fall back to a BFS. Counts only grow while a table
+// is truncated: once one of its entries loses a shared friend, someone
+// outside may overtake it, so the table is dropped and rebuilt on the next
+// read.
+class FofCandidates {
+private:
+    typedef SimpleHashTable<uint64_t, uint32_t> Counts;
+    class Entry {
+    public:
+        unique_ptr<Counts> counts; // null until built
+        bool truncated = false;
+        uint32_t floor = 0; // truncated: at most the weakest entry's count
+    };
+    vector<Entry> entries; // by dense user ID
+    size_t cap;
+    size_t built = 0;
+
+    // Candidate with the fewest shared friends (lowest ID on ties)
+    static void weakest(const Counts& counts, uint32_t& outW, uint32_t& outCount) {
+        bool first = true;
+        counts.forEach([&](const uint64_t& w, const uint32_t& c) {
+            if (first || c < outCount || (c == outCount && w < outW)) {
+                outW = static_cast<uint32_t>(w);
+                outCount = c;
+                first = false;
+            }
+        });
+    }
+
+public:
+    explicit FofCandidates(size_t maxPerUser = FOF_CANDIDATE_CAP) : cap(maxPerUser) {}
+
+    void addNode() { entries.emplace_back(); }
+
+    bool isBuilt(uint32_t u) const { return entries[u].counts != nullptr; }
+    bool anyBuilt() const { return built > 0; }
+    bool isTruncated(uint32_t u) const { return entries[u].truncated; }
+
+    // Installs u's full count table, keeping the `cap` best candidates
+    void install(uint32_t u, Counts&& counts) {
+        Entry& e = entries[u];
+        if (!e.counts) ++built;
+        e.truncated = counts.size() > cap;
+        if (!e.truncated) {
+            e.counts.reset(new Counts(std::move(counts)));
+            return;
+        }
+        vector<pair<uint32_t, uint32_t>> ranked; // (count, candidate)
+        ranked.reserve(counts.size());
+        counts.forEach([&](const uint64_t& w, const uint32_t& c) { ranked.push_back({c, static_cast<uint32_t>(w)}); });
+        nth_element(ranked.begin(), ranked.begin() + cap, ranked.end(), greater<pair<uint32_t, uint32_t>>());
+        e.counts.reset(new Counts());
+        e.counts->reserve(cap);
+        e.floor = ranked[cap].first; // the best candidate left out
+        for (size_t i = 0; i < cap; ++i) e.counts->insert(ranked[i].second, ranked[i].first);
+    }
+
+    void discard(uint32_t u) {
+        Entry& e = entries[u];
+        if (e.counts) --built;
+        e.counts.reset();
+        e.truncated = false;
+        e.floor = 0;
+    }
+
+    // One more shared friend between u and w. A full table only admits w
+    // if its total beats the table's floor; `bound` (an O(1) upper bound on
+    // that total) rejects most newcomers before sharedCount() works it
+    // out, and the table is only scanned for its weakest entry after that.
+    template <typename CountFn>
+    void bump(uint32_t u, uint32_t w, uint32_t bound, CountFn sharedCount) {
+        Entry& e = entries[u];
+        if (!e.counts) return; // built from scratch on first read
+        uint32_t* c = e.counts->search(w);
+        if (c) { ++*c; return; }
+        if (!e.truncated && e.counts->size() < cap) {
+            // Below the cap every candidate is present, so this is w's first
+            e.counts->insert(w, 1);
+            return;
+        }
+        e.truncated = true;
+        if (bound <= e.floor) return;
+        uint32_t total = sharedCount();
+        if (total <= e.floor) return;
+        uint32_t weakW = 0, weakCount = 0;
+        weakest(*e.counts, weakW, weakCount);
+        e.floor = weakCount;
+        if (total <= weakCount) return;
+        e.counts->remove(weakW);
+        e.counts->insert(w, total);
+    }
+
+    void drop(uint32_t u, uint32_t w) {
+        Entry& e = entries[u];
+        uint32_t* c = e.counts ? e.counts->search(w) : nullptr;
+        if (!c) return; // unbuilt, or left out of a truncated table
+        if (e.truncated) { discard(u); return; } // see the class comment
+        if (--*c == 0) e.counts->remove(w);
+    }
+
+    // fn(candidate, sharedFriends) over u's table
+    template <typename F>
+    void forEach(uint32_t u, F fn) const {
+        const Entry& e = entries[u];
+        if (e.counts) e.counts->forEach([&](const uint64_t& w, const uint32_t& c) { fn(static_cast<uint32_t>(w), c); });
+    }
+};
+
+class Graph {
+private:
+    // Dense 0..n-1 user IDs for bitmap-backed sets, in registration order
+    SimpleHashTable<string, uint32_t> denseIds;
+    vector<string> usernamesById;
+    // Friendships over the dense IDs: membership, traversals and updates
+    CsrGraph csr;
+    mutable FofCandidates fof; // reads build tables on demand
+    vector<uint8_t> hubs; // 1 while the user's paths are left out of fof
+    size_t hubDegree;
+
+    // Friends u and w share through non-hub users, as fof counts them
+    uint32_t sharedNonHubFriends(uint32_t u, uint32_t w) const {
+        vector<uint32_t> a, b;
+        csr.sortedNeighbours(u, a);
+        csr.sortedNeighbours(w, b);
+        uint32_t n = 0;
+        for (size_t i = 0, j = 0; i < a.size() && j < b.size(); ) {
+            if (a[i] < b[j]) ++i;
+            else if (b[j] < a[i]) ++j;
+            else { n += !hubs[a[i]]; ++i; ++j; }
+        }
+        return n;
+    }
+
+    // Count (or un-count) the shared friend behind the pair x, y in
+    // whichever of the two tables exist. Adds expect the edges already in
+    // the CSR, so a full table can look up the pair's total.
+    void addPath(uint32_t x, uint32_t y) { bumpPath(x, y); bumpPath(y, x); }
+    void bumpPath(uint32_t x, uint32_t y) {
+        uint32_t bound = static_cast<uint32_t>(min(csr.degree(x), csr.degree(y)));
+        fof.bump(x, y, bound, [&] { return sharedNonHubFriends(x, y); });
+    }
+    void removePath(uint32_t x, uint32_t y) { fof.drop(x, y); fof.drop(y, x); }
+
+    // Every pair of f's friends shares f; count or un-count it in the
+    // tables of those friends that have one
+    void forEachFriendPair(uint32_t f, bool add) {
+        if (!fof.anyBuilt()) return;
+        vector<uint32_t> row;
+        csr.sortedNeighbours(f, row);
+        for (uint32_t x : row) {
+            if (!fof.isBuilt(x)) continue;
+            for (uint32_t y : row) {
+                if (y == x) continue;
+                if (add) bumpPath(x, y);
+                else fof.drop(x, y);
+            }
+        }
+    }
+
+    // u's candidate table, built on first use with one pass over its
+    // non-hub friends' rows
+    const FofCandidates& candidatesOf(uint32_t u) const {
+        if (fof.isBuilt(u)) return fof;
+        SimpleHashTable<uint64_t, uint32_t> counts(64);
+        csr.forEachNeighbour(u, [&](uint32_t f) {
+            if (hubs[f]) return;
+            csr.forEachNeighbour(f, [&](uint32_t w) {
+                if (w == u) return;
+                uint32_t* c = counts.search(w);
+                if (c) ++*c;
+                else counts.insert(w, 1);
+            });
+        });
+        fof.install(u, std::move(counts));
+        return fof;
+    }
+
+    // Hub status with hysteresis (in above hubDegree, out below half of it),
+    // so a user hovering at the threshold doesn't repay the O(d^2) switch
+    void updateHub(uint32_t u, size_t deg) {
+        if (!hubs[u] && deg > hubDegree) { forEachFriendPair(u, false); hubs[u] = 1; }
+        else if (hubs[u] && deg < hubDegree / 2) { hubs[u] = 0; forEachFriendPair(u, true); }
+    }
+
+    bool hasHubFriend(uint32_t u) const {
+        bool found = false;
+        csr.forEachNeighbour(u, [&](uint32_t f) { if (hubs[f]) found = true; });
+        return found;
+    }
+
+    // Exact level-2 BFS, used when the cache can't answer on its own
+    vector<uint32_t> friendsOfFriendsBfs(uint32_t start) const {
+        RoaringBitmap visited;
+        visited.add(start);
+        vector<uint32_t> level1;
+        csr.forEachNeighbour(start, [&](uint32_t v) { if (visited.add(v)) level1.push_back(v); });
+        vector<uint32_t> level2;
+        for (uint32_t u : level1) {
+            csr.forEachNeighbour(u, [&](uint32_t v) { if (visited.add(v)) level2.push_back(v); });
+        }
+        return level2;
+    }
+
+    typedef pair<double, uint32_t> Scored;
+
+    // Best k of the (score, id) pairs that produce(offer) offers, highest
+    // first, ties by username. Bounded heap with the weakest kept on top.
+    template <typename Producer>
+    vector<Scored> topScored(size_t k, Producer produce) const {
+        auto better = [&](const Scored& a, const Scored& b) {
+            if (a.first != b.first) return a.first > b.first;
+            return usernamesById[a.second] < usernamesById[b.second];
+        };
+        vector<Scored> heap;
+        heap.reserve(k + 1);
+        produce([&](Scored s) {
+            if (heap.size() < k) { heap.push_back(s); push_heap(heap.begin(), heap.end(), better); }
+            else if (better(s, heap.front())) {
+                pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = s;
+                push_heap(heap.begin(), heap.end(), better);
+            }
+        });
+        sort(heap.begin(), heap.end(), better);
+        return heap;
+    }
+
+    // Monte Carlo personalised PageRank from start over `chunks` threads.
+    // Each chunk runs its share of the walks with its own generator and
+    // visit table; the tables are summed once all walks finish. Scores are
+    // visit shares, and start and its friends are left out.
+    vector<FriendSuggestion> randomWalkIds(uint32_t start, size_t k, const RandomWalkConfig& config,
+                                           size_t chunks) const {
+        if (k == 0 || config.walks == 0) return {};
+        vector<SimpleHashTable<uint64_t, uint32_t>> visits;
+        visits.reserve(chunks);
+        for (size_t c = 0; c < chunks; ++c) visits.emplace_back(64);
+        vector<size_t> steps(chunks, 0);
+        parallelFor(config.walks, chunks, [&](size_t begin, size_t end, size_t chunk) {
+            XorShift64 rng(config.seed ^ hash64(uint64_t(start) << 16 | chunk));
+            SimpleHashTable<uint64_t, uint32_t>& seen = visits[chunk];
+            size_t taken = 0;
+            for (size_t walk = begin; walk < end; ++walk) {
+                uint32_t at = start;
+                for (size_t step = 0; step < config.maxWalkLength; ++step) {
+                    if (step > 0 && rng.uniform() < config.restartProbability) break;
+                    if (!csr.randomNeighbour(at, rng, at)) break;
+                    ++taken;
+                    uint32_t* count = seen.search(at);
+                    if (count) ++*count;
+                    else seen.insert(at, 1);
+                }
+            }
+            steps[chunk] = taken;
+        });
+
+        SimpleHashTable<uint64_t, uint32_t>& total = visits[0];
+        size_t totalSteps = steps[0];
+        for (size_t c = 1; c < chunks; ++c) {
+            totalSteps += steps[c];
+            visits[c].forEach([&](const uint64_t& v, const uint32_t& n) {
+                uint32_t* count = total.search(v);
+                if (count) *count += n;
+                else total.insert(v, n);
+            });
+        }
+        if (totalSteps == 0) return {};
+
+        vector<uint32_t> friendRow;
+        csr.sortedNeighbours(start, friendRow);
+        vector<Scored> best = topScored(k, [&](const function<void(Scored)>& offer) {
+            total.forEach([&](const uint64_t& v, const uint32_t& n) {
+                uint32_t id = static_cast<uint32_t>(v);
+                if (id == start || binary_search(friendRow.begin(), friendRow.end(), id)) return;
+                offer(Scored(static_cast<double>(n) / totalSteps, id));
+            });
+        });
+
+        vector<FriendSuggestion> out;
+        out.reserve(best.size());
+        vector<uint32_t> row;
+        for (const Scored& s : best) {
+            FriendSuggestion fs;
+            fs.username = usernamesById[s.second];
+            csr.sortedNeighbours(s.second, row);
+            fs.mutualFriends = static_cast<int>(sortedIntersectionCount(friendRow, row));
+            fs.score = s.first;
+            out.push_back(fs);
+        }
+        return out;
+    }
+
+    vector<string> usernamesOf(const vector<uint32_t>& ids) const {
+        vector<string> out;
+        out.reserve(ids.size());
+        for (uint32_t id : ids) out.push_back(usernamesById[id]);
+        return out;
+    }
+
+public:
+    explicit Graph(size_t hubThreshold = FOF_HUB_DEGREE, size_t candidateCap = FOF_CANDIDATE_CAP)
+        : fof(candidateCap), hubDegree(hubThreshold) {}
+
+    void addNode(const string& username) {
+        if (denseIds.search(username)) return;
+        denseIds.insert(username, static_cast<uint32_t>(usernamesById.size()));
+        usernamesById.push_back(username);
+        fof.addNode();
+        hubs.push_back(0);
+    }
+    bool userId(const string& username, uint32_t& outId) const {
+        uint32_t* id = denseIds.search(username);
+        if (!id) return false;
+        outId = *id;
+        return true;
+    }
+    const string& usernameOf(uint32_t id) const { return usernamesById[id]; }
+    size_t nodeCount() const { return usernamesById.size(); }
+
+    // Bulk load of an edge-free graph from symmetric rows over the current
+    // dense IDs (a snapshot's friend section): row u is
+    // ids[offsets[u] .. offsets[u+1]). One CSR build replaces the per-edge
+    // updates; candidate tables are left for first reads to build.
+    void loadFriendRows(const uint64_t* offsets, const uint32_t* ids) {
+        size_t n = usernamesById.size();
+        csr.rebuild(n, [&](uint32_t u, vector<uint32_t>& row) {
+            for (uint64_t i = offsets[u]; i < offsets[u + 1]; ++i) if (ids[i] != u) row.push_back(ids[i]);
+        });
+        for (size_t u = 0; u < n; ++u) {
+            fof.discard(static_cast<uint32_t>(u));
+            hubs[u] = csr.degree(static_cast<uint32_t>(u)) > hubDegree;
+        }
+    }
+    const CsrGraph& snapshot() const { return csr; }
+
+    RoaringBitmap friendBitmap(const string& u) const {
+        RoaringBitmap out;
+        uint32_t id;
+        if (userId(u, id)) csr.forEachNeighbour(id, [&](uint32_t v) { out.add(v); });
+        return out;
+    }
+    // False if either user is unknown or they are already friends
+    bool addEdge(const string& u1, const string& u2) {
+        uint32_t id1, id2;
+        if (u1 == u2 || !userId(u1, id1) || !userId(u2, id2)) return false;
+        if (csr.hasEdge(id1, id2)) return false;
+        csr.addEdge(id1, id2);
+        if (csr.needsRebuild()) csr.compact(usernamesById.size());
+        // Each other friend x of u1 now shares u1 with u2, and vice versa
+        if (fof.anyBuilt()) {
+            if (!hubs[id1]) csr.forEachNeighbour(id1, [&](uint32_t x) { if (x != id2) addPath(x, id2); });
+            if (!hubs[id2]) csr.forEachNeighbour(id2, [&](uint32_t y) { if (y != id1) addPath(y, id1); });
+        }
+        updateHub(id1, csr.degree(id1));
+        updateHub(id2, csr.degree(id2));
+        return true;
+    }
+    // False if the two are not friends
+    bool removeEdge(const string& u1, const string& u2) {
+        uint32_t id1, id2;
+        if (!userId(u1, id1) || !userId(u2, id2) || !csr.hasEdge(id1, id2)) return false;
+        csr.removeEdge(id1, id2);
+        if (csr.needsRebuild()) csr.compact(usernamesById.size());
+        if (fof.anyBuilt()) {
+            if (!hubs[id1]) csr.forEachNeighbour(id1, [&](uint32_t x) { removePath(x, id2); });
+            if (!hubs[id2]) csr.forEachNeighbour(id2, [&](uint32_t y) { removePath(y, id1); });
+        }
+        updateHub(id1, csr.degree(id1));
+        updateHub(id2, csr.degree(id2));
+        return true;
+    }
+    bool isFriend(const string& u1, const string& u2) const {
+        uint32_t id1, id2;
+        return userId(u1, id1) && userId(u2, id2) && csr.hasEdge(id1, id2);
+    }
+    vector<string> getFriends(const string& u) const {
+        vector<uint32_t> ids;
+        uint32_t id;
+        if (userId(u, id)) csr.forEachNeighbour(id, [&](uint32_t v) { ids.push_back(v); });
+        return usernamesOf(ids);
+    }
+    // Friends of friends who are not already friends: the cached
+    // candidates plus the friends of any hub friend
+    vector<string> suggestFriends(const string& startUsername) const {
+        uint32_t start;
+        if (!userId(startUsername, start)) return {};
+        const FofCandidates& cands = candidatesOf(start);
+        if (cands.isTruncated(start)) return usernamesOf(friendsOfFriendsBfs(start));
+        RoaringBitmap seen;
+        seen.add(start);
+        csr.forEachNeighbour(start, [&](uint32_t f) { seen.add(f); });
+        vector<uint32_t> out;
+        cands.forEach(start, [&](uint32_t w, uint32_t) { if (seen.add(w)) out.push_back(w); });
+        csr.forEachNeighbour(start, [&](uint32_t f) {
+            if (hubs[f]) csr.forEachNeighbour(f, [&](uint32_t w) { if (seen.add(w)) out.push_back(w); });
+        });
+        return usernamesOf(out);
+    }
+    // Bidirectional BFS over the CSR: the smaller frontier grows one full
+    // level at a time until the two searches meet, so the work is two balls
+    // of radius ~d/2 rather than one of radius d. Stops once the two depths
+    // add up to maxDepth. Returns the hop count (or -1) and, if asked, the
+    // path from source to target.
+    int shortestPathIds(uint32_t source, uint32_t target, int maxDepth, vector<uint32_t>* outPath) const {
+        if (source == target) {
+            if (outPath) outPath->assign(1, source);
+            return 0;
+        }
+        class Reached {
+        public:
+            uint32_t parent = 0;
+            int depth = 0;
+        };
+        class Side {
+        public:
+            IdBitset visited;
+            SimpleHashTable<uint64_t, Reached> reached;
+            vector<uint32_t> frontier;
+            int depth = 0;
+            Side(size_t n, uint32_t root) : visited(n) {
+                visited.set(root);
+                reached.insert(root, Reached{root, 0});
+                frontier.push_back(root);
+            }
+        };
+        Side fromSource(usernamesById.size(), source), fromTarget(usernamesById.size(), target);
+
+        while (!fromSource.frontier.empty() && !fromTarget.frontier.empty()
+               && fromSource.depth + fromTarget.depth < maxDepth) {
+            bool growSource = fromSource.frontier.size() <= fromTarget.frontier.size();
+            Side& grow = growSource ? fromSource : fromTarget;
+            Side& other = growSource ? fromTarget : fromSource;
+
+            // 1. Collect (neighbour, via) pairs leaving the frontier; the
+            //    visited bits are only read here, so slices run in parallel
+            size_t n = grow.frontier.size();
+            size_t chunks = n >= PARALLEL_BFS_THRESHOLD ? parallelChunks(n, PARALLEL_BFS_THRESHOLD / 4) : 1;
+            vector<vector<pair<uint32_t, uint32_t>>> found(chunks);
+            parallelFor(n, chunks, [&](size_t begin, size_t end, size_t chunk) {
+                for (size_t i = begin; i < end; ++i) {
+                    uint32_t x = grow.frontier[i];
+                    csr.forEachNeighbour(x, [&](uint32_t y) {
+                        if (!grow.visited.test(y)) found[chunk].push_back({y, x});
+                    });
+                }
+            });
+
+            // 2. Mark serially and keep the shortest meeting on this level
+            ++grow.depth;
+            vector<uint32_t> next;
+            int best = -1;
+            uint32_t meet = 0;
+            for (const auto& slice : found) {
+                for (const auto& edge : slice) {
+                    uint32_t y = edge.first;
+                    if (grow.visited.test(y)) continue;
+                    grow.visited.set(y);
+                    grow.reached.insert(y, Reached{edge.second, grow.depth});
+                    next.push_back(y);
+                    if (other.visited.test(y)) {
+                        int d = grow.depth + other.reached.search(y)->depth;
+                        if (best < 0 || d < best) { best = d; meet = y; }
+                    }
+                }
+            }
+            grow.frontier.swap(next);
+            if (best < 0) continue;
+
+            if (outPath) {
+                outPath->clear();
+                for (uint32_t cur = meet; ; ) {
+                    outPath->push_back(cur);
+                    uint32_t parent = fromSource.reached.search(cur)->parent;
+                    if (parent == cur) break;
+                    cur = parent;
+                }
+                reverse(outPath->begin(), outPath->end());
+                for (uint32_t cur = meet; cur != target; ) {
+                    cur = fromTarget.reached.search(cur)->parent;
+                    outPath->push_back(cur);
+                }
+            }
+            return best;
+        }
+        return -1;
+    }
+    int degreesOfSeparation(const string& u1, const string& u2, int maxDepth = SEPARATION_MAX_DEPTH) const {
+        uint32_t id1, id2;
+        if (!userId(u1, id1) || !userId(u2, id2)) return -1;
+        return shortestPathIds(id1, id2, maxDepth, nullptr);
+    }
+    // Usernames from u1 to u2 inclusive; false if not within maxDepth hops
+    bool shortestPath(const string& u1, const string& u2, vector<string>& outPath,
+                      int maxDepth = SEPARATION_MAX_DEPTH) const {
+        uint32_t id1, id2;
+        if (!userId(u1, id1) || !userId(u2, id2)) return false;
+        vector<uint32_t> ids;
+        if (shortestPathIds(id1, id2, maxDepth, &ids) < 0) return false;
+        outPath = usernamesOf(ids);
+        return true;
+    }
+    size_t mutualFriendCount(const string& u1, const string& u2) const {
+        uint32_t id1, id2;
+        if (!userId(u1, id1) || !userId(u2, id2)) return 0;
+        vector<uint32_t> row1, row2;
+        csr.sortedNeighbours(id1, row1);
+        csr.sortedNeighbours(id2, row2);
+        return sortedIntersectionCount(row1, row2);
+    }
+    // Top-k non-friends two hops away, ranked by shared friends. Mutual
+    // counts come straight from the friend-of-friend cache when it can
+    // answer for this user (a truncated table only if its k-th pick beats
+    // its weakest entry); otherwise one pass over the friends' rows credits
+    // every path u-f-w to w, which yields each candidate's |N(u) AND N(w)|
+    // without intersecting rows pairwise.
+    // Adamic-Adar weights a shared friend f by 1 / log(degree(f)).
+    vector<FriendSuggestion> rankSuggestions(const string& startUsername, size_t k,
+                                             SuggestionScore mode = SuggestionScore::MutualFriends) const {
+        uint32_t start;
+        if (k == 0 || !userId(startUsername, start)) return {};
+        class Tally {
+        public:
+            int mutual = 0;
+            double adamicAdar = 0.0;
+        };
+        RoaringBitmap friends;
+        csr.forEachNeighbour(start, [&](uint32_t f) { friends.add(f); });
+        SimpleHashTable<uint64_t, Tally> tallies;
+        auto rank = [&]() {
+            return topScored(k, [&](const function<void(Scored)>& offer) {
+                tallies.forEach([&](const uint64_t& w, const Tally& t) {
+                    double score = mode == SuggestionScore::AdamicAdar ? t.adamicAdar : t.mutual;
+                    offer(Scored(score, static_cast<uint32_t>(w)));
+                });
+            });
+        };
+        vector<Scored> heap;
+        bool cached = false;
+        if (mode == SuggestionScore::MutualFriends && !hasHubFriend(start)) {
+            const FofCandidates& cands = candidatesOf(start);
+            double weakest = numeric_limits<double>::max();
+            cands.forEach(start, [&](uint32_t w, uint32_t count) {
+                weakest = min(weakest, static_cast<double>(count));
+                if (!friends.contains(w)) { Tally t; t.mutual = static_cast<int>(count); tallies.insert(w, t); }
+            });
+            heap = rank();
+            cached = !cands.isTruncated(start) || (heap.size() == k && heap.back().first > weakest);
+            if (!cached) tallies.clear();
+        }
+        if (!cached) {
+            csr.forEachNeighbour(start, [&](uint32_t f) {
+                double weight = 0.0;
+                if (mode == SuggestionScore::AdamicAdar) {
+                    size_t deg = csr.degree(f);
+                    weight = deg > 1 ? 1.0 / log(static_cast<double>(deg)) : 0.0;
+                }
+                csr.forEachNeighbour(f, [&](uint32_t w) {
+                    if (w == start || friends.contains(w)) return;
+                    Tally* t = tallies.search(w);
+                    if (!t) { tallies.insert(w, Tally()); t = tallies.search(w); }
+                    ++t->mutual;
+                    t->adamicAdar += weight;
+                });
+            });
+            heap = rank();
+        }
+
+        vector<FriendSuggestion> out;
+        out.reserve(heap.size());
+        for (const Scored& s : heap) {
+            FriendSuggestion fs;
+            fs.username = usernamesById[s.second];
+            fs.mutualFriends = tallies.search(s.second)->mutual;
+            fs.score = s.first;
+            out.push_back(fs);
+        }
+        return out;
+    }
+    // Top-k users by personalised PageRank from startUsername. Walks can
+    // wander past two hops, so sparse users still get results, and the
+    // walk budget caps the cost however many friends a hub has.
+    vector<FriendSuggestion> recommendByRandomWalk(const string& startUsername, size_t k,
+                                                   const RandomWalkConfig& config = RandomWalkConfig()) const {
+        uint32_t start;
+        if (!userId(startUsername, start)) return {};
+        return randomWalkIds(start, k, config, parallelChunks(config.walks, PPR_WALKS_PER_THREAD));
+    }
+    // Batch job: recommendations for every user, indexed by dense ID.
+    // Users are spread over all cores and each user's walks run inline on
+    // its worker; the walk budget keeps the slices evenly loaded.
+    vector<vector<FriendSuggestion>> recommendForAll(size_t k, const RandomWalkConfig& config = RandomWalkConfig()) const {
+        size_t n = usernamesById.size();
+        vector<vector<FriendSuggestion>> out(n);
+        parallelFor(n, parallelChunks(n, 1), [&](size_t begin, size_t end, size_t) {
+            for (size_t id = begin; id < end; ++id) out[id] = randomWalkIds(static_cast<uint32_t>(id), k, config, 1);
+        });
+        return out;
+    }
+};
+
+// Reach estimates: HyperLogLog registers per user (2^precision bytes, about
+// 1.04 / sqrt(2^precision) relative error) and the hop counts kept
+const int REACH_HLL_PRECISION = 8;
+const int REACH_MAX_HOPS = 3;
+// Users per thread when propagating sketches
+const size_t REACH_USERS_PER_THREAD = 1024;
+// Reach is rebuilt in the background, at most once per interval and only
+// after friendships changed; the GUI polls for finished builds
+const int REACH_REFRESH_INTERVAL_MS = 60000;
+const int REACH_POLL_MS = 1000;
+
+// HyperLogLog over a caller-owned register array of 2^precision bytes, so
+// that many sketches can share one flat buffer
+class HyperLogLog {
+public:
+    static void add(uint8_t* regs, int precision, uint64_t hash) {
+        size_t slot = static_cast<size_t>(hash >> (64 - precision));
+        // Rank of the first set bit after the slot bits; the guard bit caps it
+        uint64_t rest = (hash << precision) | (uint64_t(1) << (precision - 1));
+        uint8_t rank = static_cast<uint8_t>(leadingZeros64(rest) + 1);
+        if (rank > regs[slot]) regs[slot] = rank;
+    }
+
+    // dst |= src register-wise; true if dst changed
+    static bool merge(uint8_t* dst, const uint8_t* src, size_t m) {
+        bool changed = false;
+        for (size_t i = 0; i < m; ++i) {
+            if (src[i] > dst[i]) { dst[i] = src[i]; changed = true; }
+        }
+        return changed;
+    }
+
+    // Cardinality estimate, with linear counting for small sets
+    static double estimate(const uint8_t* regs, int precision) {
+        size_t m = size_t(1) << precision;
+        double sum = 0.0;
+        size_t zeros = 0;
+        for (size_t i = 0; i < m; ++i) {
+            sum += ldexp(1.0, -regs[i]);
+            if (regs[i] == 0) ++zeros;
+        }
+        double alpha = m >= 128 ? 0.7213 / (1.0 + 1.079 / m) : m == 64 ? 0.709 : m == 32 ? 0.697 : 0.673;
+        double raw = alpha * m * m / sum;
+        if (raw <= 2.5 * m && zeros > 0) return m * log(static_cast<double>(m) / zeros);
+        return raw;
+    }
+};
+
+// Estimated neighbourhood sizes |ball(u, h)| for h = 1..maxHops, built
+// HyperANF-style: every user starts with a sketch of itself, and pass h
+// merges each user's sketch with its friends' sketches from pass h - 1.
+// A pass reads the previous buffer and writes the next, so users are
+// split across threads with no locking. Queries are an array lookup.
+class ReachIndex {
+private:
+    int hops = 0;
+    vector<float> balls; // balls[id * hops + h - 1], the user included
+
+public:
+    void build(const Graph& graph, int maxHops = REACH_MAX_HOPS, int precision = REACH_HLL_PRECISION) {
+        build(graph.snapshot(), graph.nodeCount(), maxHops, precision);
+    }
+    // Over users 0..n-1 of a CSR, e.g. a copy taken for a background build
+    void build(const CsrGraph& csr, size_t n, int maxHops = REACH_MAX_HOPS, int precision = REACH_HLL_PRECISION) {
+        size_t m = size_t(1) << precision;
+        hops = maxHops;
+        balls.assign(n * hops, 0.0f);
+        vector<uint8_t> current(n * m, 0), next;
+        for (size_t u = 0; u < n; ++u) HyperLogLog::add(&current[u * m], precision, hash64(uint64_t(u)));
+
+        size_t chunks = parallelChunks(n, REACH_USERS_PER_THREAD);
+        for (int h = 1; h <= hops; ++h) {
+            next = current;
+            vector<uint8_t> changed(chunks, 0);
+            parallelFor(n, chunks, [&](size_t begin, size_t end, size_t chunk) {
+                for (size_t u = begin; u < end; ++u) {
+                    uint8_t* mine = &next[u * m];
+                    csr.forEachNeighbour(static_cast<uint32_t>(u), [&](uint32_t v) {
+                        if (HyperLogLog::merge(mine, &current[size_t(v) * m], m)) changed[chunk] = 1;
+                    });
+                    balls[u * hops + h - 1] = static_cast<float>(HyperLogLog::estimate(mine, precision));
+                }
+            });
+            current.swap(next);
+            if (find(changed.begin(), changed.end(), 1) != changed.end()) continue;
+            // Every ball has stopped growing; the later hops are the same
+            for (size_t u = 0; u < n; ++u) {
+                for (int rest = h + 1; rest <= hops; ++rest) balls[u * hops + rest - 1] = balls[u * hops + h - 1];
+            }
+            break;
+        }
+    }
+
+    // Users within `hop` hops of id, not counting id; false for IDs added
+    // since the build or hops out of range
+    bool reach(uint32_t id, int hop, double& outEstimate) const {
+        if (hop < 1 || hop > hops || size_t(id) * hops >= balls.size()) return false;
+        double ball = balls[size_t(id) * hops + hop - 1];
+        outEstimate = ball > 1.0 ? ball - 1.0 : 0.0;
+        return true;
+    }
+
+    // Mean reach over all indexed users
+    double averageReach(int hop) const {
+        if (hop < 1 || hop > hops || balls.empty()) return 0.0;
+        size_t n = balls.size() / hops;
+        double total = 0.0;
+        for (size_t u = 0; u < n; ++u) total += balls[u * hops + hop - 1];
+        return total / n - 1.0;
+    }
+};
+
+// Skip list keyed by numeric ID (ordered timeline index).
+// Expected O(log n) insert/find; the bottom level is doubly linked so range
+// scans walk iteratively in either direction without recursion.
+template <typename T>
+class SkipListNode {
+public:
+    long long key;
+    T data;
+    SkipListNode<T>* prev;
+    SkipListNode<T>** forward;
+    int height;
+    SkipListNode(long long k, const T& val, int h)
+        : key(k), data(val), prev(nullptr), forward(new SkipListNode<T>*[h]()), height(h) {}
+    ~SkipListNode() { delete[] forward; }
+};
+
+template <typename T>
+class SkipList {
+private:
+    static const int MAX_LEVEL = 32;
+    SkipListNode<T>* head; // sentinel, never holds data
+    SkipListNode<T>* tail; // last real node, nullptr when empty
+    int level;
+    size_t count;
+    uint64_t rngState;
+
+    // Geometric level with p = 1/4: two random bits per extra level
+    int randomLevel() {
+        rngState ^= rngState << 13;
+        rngState ^= rngState >> 7;
+        rngState ^= rngState << 17;
+        uint64_t bits = rngState;
+        int lvl = 1;
+        while ((bits & 3) == 0 && lvl < MAX_LEVEL) { ++lvl; bits >>= 2; }
+        return lvl;
+    }
+
+    // Fills update[i] with the last node at level i whose key is < key.
+    void findPredecessors(long long key, SkipListNode<T>** update) const {
+        SkipListNode<T>* cur = head;
+        for (int i = level - 1; i >= 0; --i) {
+            while (cur->forward[i] && cur->forward[i]->key < key) cur = cur->forward[i];
+            update[i] = cur;
+        }
+    }
+
+public:
+    SkipList() : head(new SkipListNode<T>(0, T(), MAX_LEVEL)), tail(nullptr), level(1), count(0), rngState(0x2545F4914F6CDD1DULL) {}
+    SkipList(const SkipList&) = delete;
+    SkipList& operator=(const SkipList&) = delete;
+    ~SkipList() { clear(); delete head; }
+
+    void clear() {
+        SkipListNode<T>* cur = head->forward[0];
+        while (cur) { SkipListNode<T>* next = cur->forward[0]; delete cur; cur = next; }
+        for (int i = 0; i < MAX_LEVEL; ++i) head->forward[i] = nullptr;
+        tail = nullptr;
+        level = 1;
+        count = 0;
+    }
+
+    // Inserts val under key, overwriting an existing entry with the same key.
+    void insert(long long key, const T& val) {
+        SkipListNode<T>* update[MAX_LEVEL];
+        findPredecessors(key, update);
+        SkipListNode<T>* next = update[0]->forward[0];
+        if (next && next->key == key) { next->data = val; return; }
+
+        int h = randomLevel();
+        if (h > level) {
+            for (int i = level; i < h; ++i) update[i] = head;
+            level = h;
+        }
+        SkipListNode<T>* node = new SkipListNode<T>(key, val, h);
+        for (int i = 0; i < h; ++i) {
+            node->forward[i] = update[i]->forward[i];
+            update[i]->forward[i] = node;
+        }
+        node->prev = (update[0] == head) ? nullptr : update[0];
+        if (node->forward[0]) node->forward[0]->prev = node;
+        else tail = node;
+        ++count;
+    }
+
+    T* find(long long key) const {
+        SkipListNode<T>* update[MAX_LEVEL];
+        findPredecessors(key, update);
+        SkipListNode<T>* node = update[0]->forward[0];
+        return (node && node->key == key) ? &node->data : nullptr;
+    }
+
+    // Unlinks a single node: expected O(log n).
+    bool erase(long long key) {
+        SkipListNode<T>* update[MAX_LEVEL];
+        findPredecessors(key, update);
+        SkipListNode<T>* node = update[0]->forward[0];
+        if (!node || node->key != key) return false;
+        for (int i = 0; i < node->height; ++i) update[i]->forward[i] = node->forward[i];
+        if (node->forward[0]) node->forward[0]->prev = node->prev;
+        else tail = node->prev;
+        delete node;
+        while (level > 1 && !head->forward[level - 1]) --level;
+        --count;
+        return true;
+    }
+
+    size_t size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+
+    SkipListNode<T>* first() const { return head->forward[0]; }
+    SkipListNode<T>* last() const { return tail; }
+
+    // First node with key >= key (ascending scan start).
+    SkipListNode<T>* lowerBound(long long key) const {
+        SkipListNode<T>* update[MAX_LEVEL];
+        findPredecessors(key, update);
+        return update[0]->forward[0];
+    }
+
+    // Last node with key < key (descending scan start).
+    SkipListNode<T>* lastBefore(long long key) const {
+        SkipListNode<T>* update[MAX_LEVEL];
+        findPredecessors(key, update);
+        return (update[0] == head) ? nullptr : update[0];
+    }
+
+    vector<T> toVectorInOrder() const {
+        vector<T> out;
+        out.reserve(count);
+        for (SkipListNode<T>* cur = first(); cur; cur = cur->forward[0]) out.push_back(cur->data);
+        return out;
+    }
+
+    // Newest (largest key) first.
+    vector<T> toVectorReverseInOrder() const {
+        vector<T> out;
+        out.reserve(count);
+        for (SkipListNode<T>* cur = last(); cur; cur = cur->prev) out.push_back(cur->data);
+        return out;
+    }
+
+    // The n largest keys, largest first: O(n) from the tail.
+    vector<T> newest(size_t n) const {
+        vector<T> out;
+        for (SkipListNode<T>* cur = last(); cur && out.size() < n; cur = cur->prev) out.push_back(cur->data);
+        return out;
+    }
+};
+
+const size_t INBOX_CAPACITY = 500;
+
+// Bounded per-user inbox of post numbers for fan-out-on-write feeds.
+// A ring buffer kept in ascending order: new posts always carry the largest
+// number so push() is O(1), and once full the oldest entry is overwritten.
+class PostInbox {
+private:
+    vector<long long> ring;
+    size_t start = 0; // index of the oldest entry
+    size_t count = 0;
+
+    long long& slot(size_t i) { return ring[(start + i) % ring.size()]; }
+    long long slot(size_t i) const { return ring[(start + i) % ring.size()]; }
+
+    // Replaces the contents with the newest `capacity` numbers of `sorted` (ascending, unique)
+    void assign(const vector<long long>& sorted) {
+        size_t skip = sorted.size() > ring.size() ? sorted.size() - ring.size() : 0;
+        start = 0;
+        count = sorted.size() - skip;
+        for (size_t i = 0; i < count; ++i) ring[i] = sorted[skip + i];
+    }
+
+public:
+    PostInbox() : ring(INBOX_CAPACITY) {}
+    explicit PostInbox(size_t capacity) : ring(capacity > 0 ? capacity : 1) {}
+
+    size_t size() const { return count; }
+    size_t capacity() const { return ring.size(); }
+
+    void push(long long postNumber) {
+        if (count == ring.size()) { ring[start] = postNumber; start = (start + 1) % ring.size(); }
+        else { slot(count) = postNumber; ++count; }
+    }
+
+    // i = 0 is the newest entry
+    long long newest(size_t i) const { return slot(count - 1 - i); }
+
+    // Index (from newest) of the first entry strictly below `bound`, or size() if none.
+    size_t firstBelow(long long bound) const {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (newest(mid) < bound) hi = mid; else lo = mid + 1;
+        }
+        return lo;
+    }
+
+    vector<long long> toVector() const {
+        vector<long long> out;
+        out.reserve(count);
+        for (size_t i = 0; i < count; ++i) out.push_back(slot(i));
+        return out;
+    }
+
+    // Backfill: merges older posts in, keeping order and the capacity bound
+    void merge(const vector<long long>& postNumbers) {
+        if (postNumbers.empty()) return;
+        vector<long long> all = toVector();
+        all.insert(all.end(), postNumbers.begin(), postNumbers.end());
+        sort(all.begin(), all.end());
+        all.erase(unique(all.begin(), all.end()), all.end());
+        assign(all);
+    }
+
+    // Retraction: drops every entry for which pred(postNumber) is true
+    template <typename F>
+    void removeIf(F pred) {
+        vector<long long> kept;
+        kept.reserve(count);
+        for (size_t i = 0; i < count; ++i) if (!pred(slot(i))) kept.push_back(slot(i));
+        assign(kept);
+    }
+};
+
+// Bounded LRU map from string keys to values: a hash index over a doubly
+// linked recency list. get() and put() are O(1); put() evicts the least
+// recently used entry once the capacity is reached.
+template <typename V>
+class LRUCache {
+private:
+    class Node {
+    public:
+        string key;
+        V value;
+        Node* prev;
+        Node* next;
+        Node(const string& k, const V& v) : key(k), value(v), prev(nullptr), next(nullptr) {}
+    };
+    SimpleHashTable<string, Node*> index;
+    Node* head = nullptr; // most recently used
+    Node* tail = nullptr; // least recently used
+    size_t maxEntries;
+    size_t evictions = 0;
+
+    void unlink(Node* n) {
+        if (n->prev) n->prev->next = n->next; else head = n->next;
+        if (n->next) n->next->prev = n->prev; else tail = n->prev;
+        n->prev = n->next = nullptr;
+    }
+    void pushFront(Node* n) {
+        n->next = head;
+        if (head) head->prev = n;
+        head = n;
+        if (!tail) tail = n;
+    }
+
+public:
+    explicit LRUCache(size_t capacity) : maxEntries(capacity > 0 ? capacity : 1) {}
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+    ~LRUCache() { clear(); }
+
+    V* get(const string& key) {
+        Node** found = index.search(key);
+        if (!found) return nullptr;
+        Node* n = *found;
+        unlink(n);
+        pushFront(n);
+        return &n->value;
+    }
+
+    void put(const string& key, const V& value) {
+        Node** found = index.search(key);
+        if (found) {
+            Node* n = *found;
+            n->value = value;
+            unlink(n);
+            pushFront(n);
+            return;
+        }
+        if (index.size() >= maxEntries) {
+            Node* victim = tail;
+            unlink(victim);
+            index.remove(victim->key);
+            delete victim;
+            ++evictions;
+        }
+        Node* n = new Node(key, value);
+        pushFront(n);
+        index.insert(key, n);
+    }
+
+    void clear() {
+        while (head) { Node* next = head->next; delete head; head = next; }
+        tail = nullptr;
+        index.clear();
+    }
+
+    size_t size() const { return index.size(); }
+    size_t capacity() const { return maxEntries; }
+    size_t evictionCount() const { return evictions; }
+};
+
+// --- SOCIAL MEDIA SYSTEM ---
+const size_t FEED_PAGE_SIZE = 20;
+const size_t COMMENT_PAGE_SIZE = 50;
+const size_t FEED_CACHE_CAPACITY = 256;
+
+// Tunables for the ranked "For You" feed. There are no timestamps, so
+// recency is measured in posts: a post loses half its weight every
+// halfLifePosts newer posts created system-wide.
+class RankingWeights {
+public:
+    double halfLifePosts = 200.0;
+    double likeWeight = 1.0;
+    double commentWeight = 1.5;
+    double friendWeight = 1.0;      // graph distance 1
+    double suggestionWeight = 0.5;  // graph distance 2
+    size_t perAuthorWindow = 100;   // newest posts considered per author
+};
+
+class RankedPost {
+public:
+    Post post;
+    double score = 0.0;
+};
+
+// Lightweight read model for one post: no comment or liker payloads
+class PostView {
+public:
+    string postID;
+    string authorUsername;
+    string content;
+    int likeCount = 0;
+    int friendLikeCount = 0;
+    int commentCount = 0;
+};
+
+// Candidate sets at least this large are scored on several threads
+const size_t PARALLEL_RANK_THRESHOLD = 20000;
+
+class FeedCacheStats {
+public:
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+};
+
+// Pull: the feed is computed from the global timeline on every read.
+// FanOut: createPost() pushes into each reader's inbox; reads take its head.
+enum class FeedMode { Pull, FanOut };
+
+// A post's audience is its author's two-hop neighbourhood; past this mean
+// size, pushing every post into every inbox costs more than pulling
+const double FANOUT_AUDIENCE_LIMIT = 5000.0;
+
+// One page of the feed. nextCursor is opaque to callers and empty once the
+// end of the timeline has been reached.
+class FeedPage {
+public:
+    vector<Post> posts;
+    string nextCursor;
+};
+
+// Flushes a stdio stream and forces its data to stable storage
+inline bool syncFile(FILE* f) {
+    if (fflush(f) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// Moves `from` over `to` in one step, so a crash leaves one file or the
+// other at `to`, never neither. POSIX rename already replaces atomically;
+// the directory is synced so the new name is durable too.
+inline bool replaceFile(const string& from, const string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (std::rename(from.c_str(), to.c_str()) != 0) return false;
+    size_t slash = to.rfind('/');
+    string dir = slash == string::npos ? string(".") : to.substr(0, slash + 1);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+// False only when path is known not to exist; a file that is there but
+// unreadable still counts
+inline bool fileExists(const string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return errno != ENOENT;
+    fclose(f);
+    return true;
+}
+
+// CRC-32 (IEEE, reflected), table built on first use
+inline uint32_t crc32(const char* data, size_t n) {
+    static const vector<uint32_t> table = [] {
+        vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; ++i) c = table[(c ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+// --- Binary snapshot ---
+// Layout: a fixed header, then 8-byte aligned sections of fixed-width
+// records. Strings live once in a pool and records point into it. Users
+// are stored in dense-ID order, so likers and friend rows are plain ID
+// arrays. Each post owns a contiguous run of comments and likers, and
+// CommentKeys (sorted by comment number) maps a comment back to its post.
+// Native byte order; byteOrder catches a file from another platform.
+// checkpointId names the snapshot so a write-ahead log can say which one
+// it continues.
+const char SNAPSHOT_MAGIC[8] = {'S', 'M', 'S', 'N', 'A', 'P', '\0', '\0'};
+const uint32_t SNAPSHOT_VERSION = 2;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+enum class SnapshotPart { Strings, Users, Posts, Comments, CommentKeys, Likers, FriendOffsets, FriendIds, Count };
+
+class SnapshotExtent {
+public:
+    uint64_t offset;
+    uint64_t size; // bytes
+};
+
+class SnapshotHeader {
+public:
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t checkpointId;
+    int64_t maxUserID;
+    int64_t maxPostID;
+    int64_t maxCommentID;
+    SnapshotExtent parts[static_cast<size_t>(SnapshotPart::Count)];
+};
+
+class SnapshotString {
+public:
+    uint64_t offset; // into the string pool
+    uint64_t length;
+};
+
+class SnapshotUser {
+public:
+    SnapshotString userID, username, password;
+};
+
+class SnapshotPost {
+public:
+    SnapshotString postID, author, content;
+    uint64_t firstComment, commentCount;
+    uint64_t firstLiker, likerCount;
+    int64_t likeCount; // may exceed likerCount for legacy anonymous likes
+};
+
+class SnapshotComment {
+public:
+    SnapshotString commentID, author, content, parentCommentID;
+};
+
+class SnapshotCommentKey {
+public:
+    int64_t number; // "C1234" -> 1234
+    uint64_t post;  // record in Posts
+    uint64_t index; // position in that post's comment run
+};
+
+static_assert(sizeof(SnapshotHeader) == 176, "snapshot header layout");
+static_assert(sizeof(SnapshotPost) == 88, "snapshot post layout");
+static_assert(sizeof(SnapshotComment) == 64, "snapshot comment layout");
+
+// Read-only view of a snapshot file. On POSIX the file is mmap'ed, so
+// opening costs a header check plus one pass over the fixed-width
+// sections, and pages load as they are touched. Windows reads the file
+// into memory instead.
+class SnapshotFile {
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    vector<uint64_t> buffer; // uint64_t keeps the records aligned
+#endif
+
+    const SnapshotExtent& extent(SnapshotPart part) const { return header().parts[static_cast<size_t>(part)]; }
+
+    // Every index in the fixed-width sections must land inside its target
+    // section; strings are bounds-checked as they are read
+    bool valid() const {
+        if (length < sizeof(SnapshotHeader)) return false;
+        const SnapshotHeader& h = header();
+        if (memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0) return false;
+        if (h.version != SNAPSHOT_VERSION || h.byteOrder != SNAPSHOT_BYTE_ORDER) return false;
+        for (const SnapshotExtent& e : h.parts) {
+            if (e.offset % 8 != 0 || e.offset > length || e.size > length - e.offset) return false;
+        }
+        size_t users, posts, comments, keys, likers, offsets, ids;
+        const SnapshotPost* postRecords = records<SnapshotPost>(SnapshotPart::Posts, posts);
+        const SnapshotCommentKey* keyRecords = records<SnapshotCommentKey>(SnapshotPart::CommentKeys, keys);
+        const uint32_t* likerIds = records<uint32_t>(SnapshotPart::Likers, likers);
+        const uint64_t* rowOffsets = records<uint64_t>(SnapshotPart::FriendOffsets, offsets);
+        const uint32_t* friendIds = records<uint32_t>(SnapshotPart::FriendIds, ids);
+        records<SnapshotUser>(SnapshotPart::Users, users);
+        records<SnapshotComment>(SnapshotPart::Comments, comments);
+
+        for (size_t i = 0; i < posts; ++i) {
+            const SnapshotPost& p = postRecords[i];
+            if (p.firstComment > comments || p.commentCount > comments - p.firstComment) return false;
+            if (p.firstLiker > likers || p.likerCount > likers - p.firstLiker) return false;
+        }
+        for (size_t i = 0; i < keys; ++i) {
+            if (keyRecords[i].post >= posts || keyRecords[i].index >= postRecords[keyRecords[i].post].commentCount) return false;
+        }
+        for (size_t i = 0; i < likers; ++i) if (likerIds[i] >= users) return false;
+        if (offsets != users + 1 || rowOffsets[0] != 0 || rowOffsets[users] != ids) return false;
+        for (size_t u = 0; u < users; ++u) if (rowOffsets[u] > rowOffsets[u + 1]) return false;
+        for (size_t i = 0; i < ids; ++i) if (friendIds[i] >= users) return false;
+        return true;
+    }
+
+public:
+    SnapshotFile() {}
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+    ~SnapshotFile() { close(); }
+
+    // False (and closed) if the file is missing, from another version or
+    // platform, or inconsistent
+    bool open(const string& path) {
+        close();
+#ifdef _WIN32
+        ifstream in(path, ios::binary | ios::ate);
+        if (!in) return false;
+        streamoff n = in.tellg();
+        if (n <= 0) return false;
+        buffer.resize((static_cast<size_t>(n) + 7) / 8);
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(buffer.data()), n)) { buffer.clear(); return false; }
+        base = reinterpret_cast<const char*>(buffer.data());
+        length = static_cast<size_t>(n);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps the file alive
+        if (mapped == MAP_FAILED) return false;
+        base = static_cast<const char*>(mapped);
+        length = static_cast<size_t>(st.st_size);
+#endif
+        if (valid()) return true;
+        close();
+        return false;
+    }
+
+    void close() {
+#ifdef _WIN32
+        buffer.clear();
+        buffer.shrink_to_fit();
+#else
+        if (base) munmap(const_cast<char*>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+    const SnapshotHeader& header() const { return *reinterpret_cast<const SnapshotHeader*>(base); }
+
+    template <typename T>
+    const T* records(SnapshotPart part, size_t& count) const {
+        const SnapshotExtent& e = extent(part);
+        count = static_cast<size_t>(e.size / sizeof(T));
+        return reinterpret_cast<const T*>(base + e.offset);
+    }
+
+    // Copies a pooled string out; empty if the reference is out of range
+    string text(const SnapshotString& str) const {
+        const SnapshotExtent& pool = extent(SnapshotPart::Strings);
+        if (str.offset > pool.size || str.length > pool.size - str.offset) return string();
+        return string(base + pool.offset + str.offset, static_cast<size_t>(str.length));
+    }
+
+    bool findComment(long long number, SnapshotCommentKey& outKey) const {
+        size_t count;
+        const SnapshotCommentKey* keys = records<SnapshotCommentKey>(SnapshotPart::CommentKeys, count);
+        const SnapshotCommentKey* it = lower_bound(keys, keys + count, number,
+            [](const SnapshotCommentKey& k, long long n) { return k.number < n; });
+        if (it == keys + count || it->number != number) return false;
+        outKey = *it;
+        return true;
+    }
+};
+
+// Collects the sections of a snapshot in memory, then writes them behind
+// the header in one pass
+class SnapshotWriter {
+public:
+    vector<char> pool;
+    vector<SnapshotUser> users;
+    vector<SnapshotPost> posts;
+    vector<SnapshotComment> comments;
+    vector<SnapshotCommentKey> commentKeys;
+    vector<uint32_t> likers;
+    vector<uint64_t> friendOffsets{0};
+    vector<uint32_t> friendIds;
+
+    SnapshotString add(const string& str) {
+        SnapshotString ref{pool.size(), str.size()};
+        pool.insert(pool.end(), str.begin(), str.end());
+        return ref;
+    }
+
+    // Writes and syncs path + ".tmp", then renames it over path, so a
+    // failed write leaves the previous snapshot in place
+    bool write(const string& path, uint64_t checkpointId, int64_t maxUserID, int64_t maxPostID, int64_t maxCommentID) {
+        sort(commentKeys.begin(), commentKeys.end(),
+             [](const SnapshotCommentKey& a, const SnapshotCommentKey& b) { return a.number < b.number; });
+        SnapshotHeader h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+        h.version = SNAPSHOT_VERSION;
+        h.byteOrder = SNAPSHOT_BYTE_ORDER;
+        h.checkpointId = checkpointId;
+        h.maxUserID = maxUserID;
+        h.maxPostID = maxPostID;
+        h.maxCommentID = maxCommentID;
+
+        const void* data[] = {pool.data(), users.data(), posts.data(), comments.data(), commentKeys.data(),
+                              likers.data(), friendOffsets.data(), friendIds.data()};
+        size_t bytes[] = {pool.size(), users.size() * sizeof(SnapshotUser), posts.size() * sizeof(SnapshotPost),
+                          comments.size() * sizeof(SnapshotComment), commentKeys.size() * sizeof(SnapshotCommentKey),
+                          likers.size() * sizeof(uint32_t), friendOffsets.size() * sizeof(uint64_t),
+                          friendIds.size() * sizeof(uint32_t)};
+        const size_t partCount = static_cast<size_t>(SnapshotPart::Count);
+        uint64_t offset = sizeof(SnapshotHeader);
+        for (size_t i = 0; i < partCount; ++i) {
+            h.parts[i].offset = offset;
+            h.parts[i].size = bytes[i];
+            offset = (offset + bytes[i] + 7) & ~uint64_t(7);
+        }
+
+        string tmp = path + ".tmp";
+        FILE* out = fopen(tmp.c_str(), "wb");
+        if (!out) return false;
+        bool ok = fwrite(&h, sizeof(h), 1, out) == 1;
+        const char padding[8] = {0};
+        for (size_t i = 0; ok && i < partCount; ++i) {
+            size_t pad = (8 - bytes[i] % 8) % 8;
+            ok = (bytes[i] == 0 || fwrite(data[i], 1, bytes[i], out) == bytes[i])
+                 && (pad == 0 || fwrite(padding, 1, pad, out) == pad);
+        }
+        ok = ok && syncFile(out);
+        ok = fclose(out) == 0 && ok;
+        if (!ok) { std::remove(tmp.c_str()); return false; }
+        return replaceFile(tmp, path);
+    }
+};
+
+// --- Write-ahead log ---
+// Every mutation is appended as a compact record, and on startup the
+// records are replayed on top of the snapshot they follow. The file is a
+// WalHeader naming that snapshot's checkpoint ID, then records of
+// [u32 payload length][u32 CRC-32 of payload][payload], where the payload
+// is an op byte and length-prefixed string fields. Replay stops at the
+// first short or corrupt record: a write torn by a crash.
+const char WAL_MAGIC[8] = {'S', 'M', 'W', 'A', 'L', '\0', '\0', '\0'};
+const uint32_t WAL_VERSION = 1;
+// Group commit: records are buffered and written with one fsync once this
+// many bytes are pending or the oldest has waited this long. A crash can
+// lose at most that window.
+const size_t WAL_GROUP_COMMIT_BYTES = 64 * 1024;
+const int WAL_GROUP_COMMIT_MS = 50;
+// Past this size the log is folded into a fresh snapshot and restarted
+const uint64_t WAL_CHECKPOINT_BYTES = uint64_t(64) << 20;
+
+enum class WalOp : uint8_t {
+    RegisterUser = 1, CreatePost, EditPost, DeletePost, AddComment, AddReply, ToggleLike, AddFriend, RemoveFriend
+};
+
+class WalHeader {
+public:
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t checkpointId;
+};
+
+class WalRecord {
+public:
+    WalOp op = WalOp::RegisterUser;
+    vector<string> fields;
+};
+
+// Superseded: a log of an older checkpoint, whose records the snapshot
+// already holds. Foreign: anything else that is not this snapshot's log.
+enum class WalReplay { Missing, Foreign, Superseded, Replayed };
+
+class WriteAheadLog {
+private:
+    FILE* file = nullptr;
+    vector<char> pending; // encoded records not yet written
+    chrono::steady_clock::time_point oldestPending;
+    uint64_t written = 0; // bytes in the file
+
+    static void put32(vector<char>& out, uint32_t v) {
+        char b[4];
+        memcpy(b, &v, 4);
+        out.insert(out.end(), b, b + 4);
+    }
+    static uint32_t get32(const char* p) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        return v;
+    }
+
+    // Truncates the file to n bytes and moves to its end
+    bool cutAt(uint64_t n) {
+#ifdef _WIN32
+        bool cut = _chsize_s(_fileno(file), static_cast<long long>(n)) == 0;
+#else
+        bool cut = ftruncate(fileno(file), static_cast<off_t>(n)) == 0;
+#endif
+        if (!cut || fseek(file, 0, SEEK_END) != 0) return false;
+        written = n;
+        return true;
+    }
+
+public:
+    WriteAheadLog() {}
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+    ~WriteAheadLog() { close(); }
+
+    // Calls fn(record) for each intact record of the log at path, if it
+    // follows checkpoint `checkpointId`. validBytes is the length of the
+    // intact prefix, where appending should resume.
+    template <typename F>
+    static WalReplay replay(const string& path, uint64_t checkpointId, F fn, uint64_t& validBytes) {
+        ifstream in(path, ios::binary);
+        if (!in) return WalReplay::Missing;
+        vector<char> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        WalHeader h;
+        if (data.size() < sizeof(h)) return WalReplay::Foreign;
+        memcpy(&h, data.data(), sizeof(h));
+        if (memcmp(h.magic, WAL_MAGIC, sizeof(h.magic)) != 0 || h.version != WAL_VERSION) return WalReplay::Foreign;
+        if (h.checkpointId < checkpointId) return WalReplay::Superseded;
+        if (h.checkpointId != checkpointId) return WalReplay::Foreign;
+
+        size_t at = sizeof(h);
+        while (data.size() - at >= 8) {
+            uint32_t length = get32(&data[at]);
+            if (length == 0 || length > data.size() - at - 8) break;
+            const char* payload = &data[at + 8];
+            if (crc32(payload, length) != get32(&data[at + 4])) break;
+            WalRecord r;
+            r.op = static_cast<WalOp>(static_cast<uint8_t>(payload[0]));
+            bool intact = true;
+            for (size_t i = 1; i < length; ) {
+                if (length - i < 4 || get32(payload + i) > length - i - 4) { intact = false; break; }
+                uint32_t n = get32(payload + i);
+                r.fields.emplace_back(payload + i + 4, n);
+                i += 4 + n;
+            }
+            if (!intact) break;
+            fn(r);
+            at += 8 + length;
+        }
+        validBytes = at;
+        return WalReplay::Replayed;
+    }
+
+    // Writes and syncs an empty log following checkpoint `checkpointId`;
+    // it is not opened
+    static bool create(const string& path, uint64_t checkpointId) {
+        FILE* out = fopen(path.c_str(), "wb");
+        if (!out) return false;
+        WalHeader h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, WAL_MAGIC, sizeof(h.magic));
+        h.version = WAL_VERSION;
+        h.checkpointId = checkpointId;
+        bool ok = fwrite(&h, sizeof(h), 1, out) == 1 && syncFile(out);
+        ok = fclose(out) == 0 && ok;
+        if (!ok) std::remove(path.c_str());
+        return ok;
+    }
+
+    // Continues a replayed log, cutting off any torn tail. The current log
+    // is only closed once the new one is open.
+    bool openAt(const string& path, uint64_t validBytes) {
+        FILE* next = fopen(path.c_str(), "r+b");
+        if (!next) return false;
+        close();
+        file = next;
+        if (cutAt(validBytes)) return true;
+        close();
+        return false;
+    }
+
+    // Moves to an empty log made by create(). Pending records are dropped:
+    // the checkpoint that precedes the switch already holds them.
+    bool switchTo(const string& path) {
+        if (!openAt(path, sizeof(WalHeader))) return false;
+        pending.clear();
+        return true;
+    }
+
+    // Replaces the log at path with an empty one following checkpoint
+    // `checkpointId`
+    bool reset(const string& path, uint64_t checkpointId) {
+        string fresh = path + ".tmp";
+        if (!create(fresh, checkpointId)) return false;
+        if (!replaceFile(fresh, path)) { std::remove(fresh.c_str()); return false; }
+        return switchTo(path);
+    }
+
+    void close() {
+        if (file) fclose(file);
+        file = nullptr;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+    void append(WalOp op, initializer_list<string> fields) {
+        if (pending.empty()) oldestPending = chrono::steady_clock::now();
+        size_t start = pending.size();
+        put32(pending, 0); // length and CRC, patched below
+        put32(pending, 0);
+        pending.push_back(static_cast<char>(op));
+        for (const string& f : fields) {
+            put32(pending, static_cast<uint32_t>(f.size()));
+            pending.insert(pending.end(), f.begin(), f.end());
+        }
+        uint32_t length = static_cast<uint32_t>(pending.size() - start - 8);
+        uint32_t crc = crc32(&pending[start + 8], length);
+        memcpy(&pending[start], &length, 4);
+        memcpy(&pending[start + 4], &crc, 4);
+    }
+
+    bool isDue() const {
+        if (pending.empty()) return false;
+        if (pending.size() >= WAL_GROUP_COMMIT_BYTES) return true;
+        return chrono::steady_clock::now() - oldestPending >= chrono::milliseconds(WAL_GROUP_COMMIT_MS);
+    }
+
+    // Writes the pending group and fsyncs once for all of it
+    bool sync() {
+        if (pending.empty()) return true;
+        if (!file) return false;
+        if (fwrite(pending.data(), 1, pending.size(), file) != pending.size() || !syncFile(file)) {
+            cutAt(written); // drop a partial group; it stays pending for the next try
+            return false;
+        }
+        written += pending.size();
+        pending.clear();
+        return true;
+    }
+
+    size_t pendingBytes() const { return pending.size(); }
+    uint64_t size() const { return written + pending.size(); }
+};
+
+class SocialMediaSystem {
+private:
+    SimpleHashTable<string, User> userHash;
+    SimpleHashTable<string, PostLog> userPosts;
+    // Comments of snapshot posts are materialised on first read, by const
+    // readers too; see commentsFor()
+    mutable SimpleHashTable<string, CommentLog> postComments;
+    SimpleHashTable<string, LikerSet> postLikes;
+    LikeBatcher likeBatcher; // toggles not yet applied to postLikes
+    function<void(const string&, int)> likeCountListener;
+    Graph friendGraph;
+    // Reach estimates: readers get the last finished build while the next
+    // one runs on a worker over a copy of the friend graph
+    ReachIndex reachIndex;
+    future<ReachIndex> reachBuild; // valid() while a background build is in flight
+    bool reachBuilt = false;
+    chrono::steady_clock::time_point reachStartedAt;
+    size_t edgesChangedSinceReach = 0; // friendships added or removed since the last build started
+    // Last batch of random-walk recommendations, by username
+    SimpleHashTable<string, vector<FriendSuggestion>> precomputedRecommendations;
+    // All posts keyed by numeric post ID; each entry points at the record in
+    // the author's PostLog (re-pointed with postIndex after a compaction)
+    SkipList<Post*> postTimeline;
+    // postID -> record and slot in the author's PostLog
+    class PostRef {
+    public:
+        Post* record = nullptr;
+        size_t slot = 0;
+    };
+    SimpleHashTable<string, PostRef> postIndex;
+    // commentID -> owning post and position in its CommentLog
+    class CommentRef {
+    public:
+        string postID;
+        size_t index = 0;
+    };
+    mutable SimpleHashTable<string, CommentRef> commentIndex;
+    // The loaded snapshot stays mapped while posts' comments are still in it
+    SnapshotFile snapshotFile;
+    uint64_t checkpointId = 0; // of the snapshot the log continues
+    WriteAheadLog wal;
+    string walPath; // WAL_FILE, or the fresh log a checkpoint could not rename
+    mutable SimpleHashTable<string, size_t> unloadedComments; // postID -> snapshot post record
+
+    FeedMode feedMode = FeedMode::Pull;
+    bool feedModePinned = false; // set by setFeedMode(); otherwise reach builds choose
+    SimpleHashTable<string, PostInbox> inboxes; // maintained only in FanOut mode
+
+    // Feed result cache. A post write bumps only its author's version, and
+    // a page records the versions of the candidate authors it was built
+    // from, so reads find out whether it is stale. Friendship changes alter
+    // who the candidates are; they bump the feed version of the readers
+    // near the edge instead.
+    class CachedFeedPage {
+    public:
+        FeedPage page;
+        unsigned long long version = 0; // the reader's feed version
+        vector<pair<string, unsigned long long>> authors; // candidate -> posts version
+    };
+    SimpleHashTable<string, unsigned long long> feedVersions;
+    SimpleHashTable<string, unsigned long long> postVersions; // author -> posts created, edited or deleted
+    mutable LRUCache<CachedFeedPage> feedCache{FEED_CACHE_CAPACITY};
+    mutable size_t feedCacheHits = 0;
+    mutable size_t feedCacheMisses = 0;
+
+    RankingWeights rankingWeights;
+
+    User* currentUser = nullptr;
+
+    // ID Tracking to prevent duplicates across sessions
+    int maxUserID = 0;
+    int maxPostID = 99; // Starts at 100
+    int maxCommentID = 999; // Starts at 1000
+
+    const string USERS_FILE = "users.txt";
+    const string POSTS_FILE = "posts.txt";
+    const string COMMENTS_FILE = "comments.txt";
+    const string FRIENDS_FILE = "friends.txt";
+    const string LIKES_FILE = "likes.txt";
+    const string SNAPSHOT_FILE = "snapshot.bin";
+    const string WAL_FILE = "wal.log";
+
+    // Helper to extract numeric part from ID (e.g., P105 -> 105)
+    int extractID(string_view idStr, char prefix) const {
+        int n;
+        if (idStr.size() < 2 || idStr[0] != prefix || !parseInt(idStr.substr(1), n)) return 0;
+        return n;
+    }
+
+    // Feed cursors carry the numeric ID of the last post handed out
+    static string encodeFeedCursor(long long postNumber) { return "F" + to_string(postNumber); }
+    static long long decodeFeedCursor(const string& cursor) { return idNumber(cursor); }
+
+    // Readers whose feed includes `author`: friends and second-degree contacts
+    vector<string> feedAudience(const string& author) const {
+        vector<string> audience = friendGraph.getFriends(author);
+        vector<string> secondDegree = friendGraph.suggestFriends(author);
+        audience.insert(audience.end(), secondDegree.begin(), secondDegree.end());
+        return audience;
+    }
+
+    bool withinTwoHops(const string& u, const string& w) const {
+        if (friendGraph.isFriend(u, w)) return true;
+        for (const string& f : friendGraph.getFriends(u)) {
+            if (friendGraph.isFriend(f, w)) return true;
+        }
+        return false;
+    }
+
+    PostLog& postLogFor(const string& author) {
+        PostLog* log = userPosts.search(author);
+        if (!log) { userPosts.insert(author, PostLog()); log = userPosts.search(author); }
+        return *log;
+    }
+
+    // Applied state with any buffered toggle for this user folded in
+    bool likedBy(const string& postID, const LikerSet& likers, uint32_t userId) const {
+        const PendingLikes* p = likeBatcher.find(postID);
+        return likers.contains(userId) != (p && p->toggled.contains(userId));
+    }
+
+    // Files a comment under its parent when the parent is a known comment
+    // on the same post, otherwise at top level
+    // const only because snapshot comments are materialised from readers
+    void appendComment(CommentLog& comments, Comment c) const {
+        long long parentIndex = -1;
+        if (c.isReply()) {
+            CommentRef* parent = commentIndex.search(c.parentCommentID);
+            if (parent && parent->postID == c.postID) parentIndex = static_cast<long long>(parent->index);
+        }
+        // Indexed first: the comment itself is moved into the log
+        commentIndex.insert(c.commentID, CommentRef{c.postID, comments.size()});
+        comments.append(std::move(c), parentIndex);
+    }
+
+    Comment snapshotComment(const SnapshotComment& rec, const string& postID) const {
+        return Comment(snapshotFile.text(rec.commentID), postID, snapshotFile.text(rec.author),
+                       snapshotFile.text(rec.content), snapshotFile.text(rec.parentCommentID));
+    }
+
+    // Posts get a CommentLog with their first comment; most never do
+    CommentLog& commentLogFor(const string& postID) const {
+        CommentLog* comments = postComments.search(postID);
+        if (!comments) { postComments.insert(postID, CommentLog()); comments = postComments.search(postID); }
+        return *comments;
+    }
+
+    // A post's CommentLog, first pulling its comments out of the snapshot
+    // if they are still there. Null for posts without comments.
+    CommentLog* commentsFor(const string& postID) const {
+        size_t* pending = unloadedComments.search(postID);
+        if (pending) {
+            size_t record = *pending;
+            unloadedComments.remove(postID);
+            size_t postCount, commentCount;
+            const SnapshotPost& post = snapshotFile.records<SnapshotPost>(SnapshotPart::Posts, postCount)[record];
+            const SnapshotComment* all = snapshotFile.records<SnapshotComment>(SnapshotPart::Comments, commentCount);
+            CommentLog& comments = commentLogFor(postID);
+            for (uint64_t i = 0; i < post.commentCount; ++i) {
+                appendComment(comments, snapshotComment(all[post.firstComment + i], postID));
+            }
+        }
+        return postComments.search(postID);
+    }
+
+    // Looks a comment up by ID, loading its post's comments if needed
+    CommentRef* findComment(const string& commentID) const {
+        CommentRef* ref = commentIndex.search(commentID);
+        if (ref || unloadedComments.isEmpty()) return ref;
+        SnapshotCommentKey key;
+        if (!snapshotFile.findComment(idNumber(commentID), key)) return nullptr;
+        size_t postCount;
+        const SnapshotPost* posts = snapshotFile.records<SnapshotPost>(SnapshotPart::Posts, postCount);
+        commentsFor(snapshotFile.text(posts[key.post].postID));
+        return commentIndex.search(commentID);
+    }
+
+    // fn(comment) over a post's comments, oldest first, wherever they live;
+    // nothing is materialised
+    template <typename F>
+    void forEachStoredComment(const string& postID, F fn) const {
+        size_t* pending = unloadedComments.search(postID);
+        if (!pending) {
+            CommentLog* comments = postComments.search(postID);
+            if (comments) comments->forEach(fn);
+            return;
+        }
+        size_t postCount, commentCount;
+        const SnapshotPost& post = snapshotFile.records<SnapshotPost>(SnapshotPart::Posts, postCount)[*pending];
+        const SnapshotComment* all = snapshotFile.records<SnapshotComment>(SnapshotPart::Comments, commentCount);
+        for (uint64_t i = 0; i < post.commentCount; ++i) fn(snapshotComment(all[post.firstComment + i], postID));
+    }
+
+    // fn(userId) over the effective likers: the applied set with buffered
+    // toggles folded in
+    template <typename F>
+    void forEachLiker(const string& postID, const LikerSet& likers, F fn) const {
+        const PendingLikes* p = likeBatcher.find(postID);
+        likers.forEach([&](uint32_t userId) { if (!p || !p->toggled.contains(userId)) fn(userId); });
+        if (p) p->toggled.forEach([&](uint32_t userId) { if (!likers.contains(userId)) fn(userId); });
+    }
+
+    // Logs must be in ID order; then index every record once
+    void indexAllPostLogs() {
+        userPosts.forEach([this](const string&, PostLog& log) {
+            if (!log.isSorted()) log.compact();
+            indexPostLog(log);
+        });
+    }
+
+    // (Re)points postIndex and the timeline at every live record of a log
+    void indexPostLog(const PostLog& log) {
+        log.forEach([this, &log](size_t slot, const Post& p) {
+            PostRef ref;
+            ref.record = log.at(slot);
+            ref.slot = slot;
+            postIndex.insert(p.postID, ref);
+            postTimeline.insert(p.number(), ref.record);
+        });
+    }
+
+    unsigned long long feedVersion(const string& username) const {
+        unsigned long long* v = feedVersions.search(username);
+        return v ? *v : 0;
+    }
+    void bumpFeedVersion(const string& username) {
+        unsigned long long* v = feedVersions.search(username);
+        if (v) ++*v; else feedVersions.insert(username, 1);
+    }
+    unsigned long long postsVersion(const string& author) const {
+        unsigned long long* v = postVersions.search(author);
+        return v ? *v : 0;
+    }
+    // A post by `author` changed; cached pages built from them see it on read
+    void bumpPostsVersion(const string& author) {
+        unsigned long long* v = postVersions.search(author);
+        if (v) ++*v; else postVersions.insert(author, 1);
+    }
+    bool isCurrent(const CachedFeedPage& cached, const string& reader) const {
+        if (cached.version != feedVersion(reader)) return false;
+        for (const auto& a : cached.authors) if (postsVersion(a.first) != a.second) return false;
+        return true;
+    }
+    // Edge (a, b) changed: a, b and their friends gain or lose two-hop authors
+    void invalidateNeighbourhood(const string& a, const string& b, const vector<string>& friendsOfA, const vector<string>& friendsOfB) {
+        bumpFeedVersion(a);
+        bumpFeedVersion(b);
+        for (const string& x : friendsOfA) bumpFeedVersion(x);
+        for (const string& y : friendsOfB) bumpFeedVersion(y);
+    }
+
+    PostInbox& inboxFor(const string& username) {
+        PostInbox* inbox = inboxes.search(username);
+        if (!inbox) { inboxes.insert(username, PostInbox(INBOX_CAPACITY)); inbox = inboxes.search(username); }
+        return *inbox;
+    }
+
+    // Newest post numbers by `author`, at most one inbox worth
+    vector<long long> recentPostNumbers(const string& author) const {
+        vector<long long> out;
+        PostLog* log = userPosts.search(author);
+        if (!log) return out;
+        for (long long i = log->newestSlot(); i >= 0 && out.size() < INBOX_CAPACITY; i = log->previousSlot(i)) {
+            out.push_back(log->at(i)->number());
+        }
+        return out;
+    }
+
+    // Backfills both inboxes after `reader` and `author` came within two hops
+    void backfillPair(const string& reader, const string& author) {
+        inboxFor(reader).merge(recentPostNumbers(author));
+        inboxFor(author).merge(recentPostNumbers(reader));
+    }
+
+    // Retracts both directions if the pair is no longer within two hops
+    void retractPair(const string& a, const string& b) {
+        if (a == b || withinTwoHops(a, b)) return;
+        PostInbox* inboxA = inboxes.search(a);
+        if (inboxA) inboxA->removeIf([&](long long n) { Post** p = postTimeline.find(n); return !p || (*p)->authorUsername == b; });
+        PostInbox* inboxB = inboxes.search(b);
+        if (inboxB) inboxB->removeIf([&](long long n) { Post** p = postTimeline.find(n); return !p || (*p)->authorUsername == a; });
+    }
+
+    void rebuildInboxes() {
+        inboxes.clear();
+        userHash.forEach([this](const string& username, const User&) {
+            vector<long long> merged;
+            for (const string& author : feedAudience(username)) {
+                vector<long long> recent = recentPostNumbers(author);
+                merged.insert(merged.end(), recent.begin(), recent.end());
+            }
+            if (!merged.empty()) inboxFor(username).merge(merged);
+        });
+    }
+
+    // Switching to FanOut materialises every inbox once; afterwards they are
+    // maintained by createPost/addFriend/removeFriend. Pull drops them.
+    void switchFeedMode(FeedMode mode) {
+        if (mode == feedMode) return;
+        feedMode = mode;
+        feedCache.clear();
+        if (feedMode == FeedMode::FanOut) rebuildInboxes();
+        else inboxes.clear();
+    }
+
+    // Installs finished reach estimates and, unless setFeedMode() fixed
+    // the mode, follows recommendedFeedMode()
+    void adoptReachIndex(ReachIndex index) {
+        reachIndex = std::move(index);
+        reachBuilt = true;
+        if (!feedModePinned) switchFeedMode(recommendedFeedMode());
+    }
+
+    // K-way merge over the per-author lists of friends and suggestions.
+    // Each list is newest-first, so a max-heap on post number yields the
+    // feed in order and the scan stops after `limit` posts: the cost scales
+    // with the number of candidate authors and the page size, not with the
+    // global post volume.
+    // `authors` are the candidates: friends, then second-degree contacts
+    // (feedAudience of the reader)
+    FeedPage pullFeedPage(const vector<string>& authors, const string& cursor, size_t limit) const {
+        FeedPage page;
+        const string& me = currentUser->username;
+
+        // 2. Seed the heap with each author's newest post older than the cursor
+        long long bound = cursor.empty() ? numeric_limits<long long>::max() : decodeFeedCursor(cursor);
+        class AuthorCursor {
+        public:
+            const PostLog* log;
+            long long slot;
+            long long number;
+        };
+        auto newer = [](const AuthorCursor& a, const AuthorCursor& b) { return a.number < b.number; };
+        vector<AuthorCursor> heap;
+        heap.reserve(authors.size());
+        for (const string& author : authors) {
+            if (author == me) continue;
+            PostLog* log = userPosts.search(author);
+            if (!log) continue;
+            long long slot = log->newestSlotBelow(bound);
+            if (slot >= 0) heap.push_back(AuthorCursor{log, slot, log->at(slot)->number()});
+        }
+        make_heap(heap.begin(), heap.end(), newer);
+
+        // 3. Pop the newest head, then advance that author's cursor
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end(), newer);
+            AuthorCursor top = heap.back();
+            heap.pop_back();
+            page.posts.push_back(*top.log->at(top.slot));
+            long long older = top.log->previousSlot(top.slot);
+            if (older >= 0) {
+                heap.push_back(AuthorCursor{top.log, older, top.log->at(older)->number()});
+                push_heap(heap.begin(), heap.end(), newer);
+            }
+            if (page.posts.size() == limit) {
+                if (!heap.empty()) page.nextCursor = encodeFeedCursor(top.number);
+                break;
+            }
+        }
+        return page;
+    }
+
+    // Reads the head of the materialised inbox; deleted posts are skipped lazily
+    FeedPage inboxFeedPage(const string& cursor, size_t limit) const {
+        FeedPage page;
+        PostInbox* inbox = inboxes.search(currentUser->username);
+        if (!inbox) return page;
+        size_t i = cursor.empty() ? 0 : inbox->firstBelow(decodeFeedCursor(cursor));
+        for (; i < inbox->size(); ++i) {
+            long long n = inbox->newest(i);
+            Post** p = postTimeline.find(n);
+            if (!p) continue;
+            page.posts.push_back(**p);
+            if (page.posts.size() == limit) {
+                if (i + 1 < inbox->size()) page.nextCursor = encodeFeedCursor(n);
+                break;
+            }
+        }
+        return page;
+    }
+
+    string generateUserID() { return "U" + to_string(++maxUserID); }
+    string generatePostID() { return "P" + to_string(++maxPostID); }
+    string generateCommentID() { return "C" + to_string(++maxCommentID); }
+
+    // Each file is read in large blocks and split in place; only the
+    // fields that are stored get copied out of the buffer
+    void loadDataInternal() {
+        LineReader reader;
+        string_view line;
+        vector<string_view> parts;
+        reader.open(USERS_FILE);
+        while (reader.next(line)) {
+            User u = User::fromString(line, parts);
+            if (!u.username.empty()) {
+                friendGraph.addNode(u.username);
+                // Update Max ID
+                int idNum = extractID(u.userID, 'U');
+                if (idNum > maxUserID) maxUserID = idNum;
+                string username = u.username; // the key outlives the moved record
+                userHash.insert(username, std::move(u));
+            }
+        }
+
+        reader.open(POSTS_FILE);
+        while (reader.next(line)) {
+            int likesFromFile = 0;
+            Post p = Post::fromString(line, parts, &likesFromFile);
+            if (!p.postID.empty()) {
+                // Update Max ID
+                int idNum = extractID(p.postID, 'P');
+                if (idNum > maxPostID) maxPostID = idNum;
+
+                // Count-only until likes.txt names the likers
+                postLikes.insert(p.postID, LikerSet(likesFromFile));
+                PostLog& log = postLogFor(p.authorUsername);
+                log.append(std::move(p));
+            }
+        }
+        indexAllPostLogs();
+
+        reader.open(COMMENTS_FILE);
+        while (reader.next(line)) {
+            Comment c = Comment::fromString(line, parts);
+            if (!c.commentID.empty()) {
+                // Update Max ID
+                int idNum = extractID(c.commentID, 'C');
+                if (idNum > maxCommentID) maxCommentID = idNum;
+
+                if (!postIndex.search(c.postID)) continue;
+                CommentLog& comments = commentLogFor(c.postID); // before c is moved from
+                appendComment(comments, std::move(c));
+            }
+        }
+
+        // IDs and usernames are short, so these lookup keys stay in the
+        // string's inline buffer
+        string key, other;
+        reader.open(LIKES_FILE);
+        while (reader.next(line)) {
+            splitFields(line, '|', parts);
+            if (parts.size() < 2) continue;
+            key.assign(parts[0]);
+            other.assign(parts[1]);
+            uint32_t userId;
+            if (friendGraph.userId(other, userId)) {
+                LikerSet* likers = postLikes.search(key);
+                if (likers) likers->addLoaded(userId);
+            }
+        }
+
+        reader.open(FRIENDS_FILE);
+        while (reader.next(line)) {
+            splitFields(line, '|', parts);
+            if (parts.size() < 2) continue;
+            key.assign(parts[0]);
+            other.assign(parts[1]);
+            friendGraph.addEdge(key, other);
+        }
+        reader.close();
+    }
+
+    // Rebuilds the in-memory indexes from the snapshot's fixed-width
+    // records; no text is parsed. Comments stay in the mapping until their
+    // post is first read, but users and posts are copied out and their
+    // hash tables and the timeline rebuilt, so opening is still linear in
+    // their number. False if there is no snapshot; one that is there but
+    // unusable stops startup rather than be checkpointed over.
+    bool loadSnapshot() {
+        if (!snapshotFile.open(SNAPSHOT_FILE)) {
+            if (!fileExists(SNAPSHOT_FILE)) return false;
+            // The text files are only the first launch's import, so they are no fallback
+            throw runtime_error(SNAPSHOT_FILE + " is damaged or from another version; restore it from a backup. "
+                                + WAL_FILE + " holds only the changes made since it was written.");
+        }
+        const SnapshotHeader& h = snapshotFile.header();
+        checkpointId = h.checkpointId;
+        maxUserID = static_cast<int>(h.maxUserID);
+        maxPostID = static_cast<int>(h.maxPostID);
+        maxCommentID = static_cast<int>(h.maxCommentID);
+        size_t userCount, postCount;
+        const SnapshotUser* users = snapshotFile.records<SnapshotUser>(SnapshotPart::Users, userCount);
+        const SnapshotPost* posts = snapshotFile.records<SnapshotPost>(SnapshotPart::Posts, postCount);
+        userHash.reserve(userCount);
+        postIndex.reserve(postCount);
+        postLikes.reserve(postCount);
+
+        // Stored in dense-ID order, so registering them in turn reproduces the IDs
+        for (size_t i = 0; i < userCount; ++i) {
+            string username = snapshotFile.text(users[i].username);
+            friendGraph.addNode(username);
+            userHash.insert(username, User(snapshotFile.text(users[i].userID), username,
+                                           snapshotFile.text(users[i].password)));
+        }
+
+        // A post gets its CommentLog when its comments are first read
+        size_t likerCount;
+        const uint32_t* likerIds = snapshotFile.records<uint32_t>(SnapshotPart::Likers, likerCount);
+        for (size_t i = 0; i < postCount; ++i) {
+            const SnapshotPost& rec = posts[i];
+            Post p(snapshotFile.text(rec.postID), snapshotFile.text(rec.author), snapshotFile.text(rec.content));
+            if (rec.commentCount > 0) unloadedComments.insert(p.postID, i);
+            LikerSet likers(static_cast<int>(rec.likeCount));
+            for (uint64_t j = 0; j < rec.likerCount; ++j) likers.addLoaded(likerIds[rec.firstLiker + j]);
+            postLikes.insert(p.postID, std::move(likers));
+            PostLog& log = postLogFor(p.authorUsername);
+            log.append(std::move(p));
+        }
+        indexAllPostLogs();
+
+        size_t offsetCount, idCount;
+        const uint64_t* rowOffsets = snapshotFile.records<uint64_t>(SnapshotPart::FriendOffsets, offsetCount);
+        const uint32_t* friendIds = snapshotFile.records<uint32_t>(SnapshotPart::FriendIds, idCount);
+        friendGraph.loadFriendRows(rowOffsets, friendIds);
+        return true;
+    }
+
+    // Writes the whole dataset as a binary snapshot (see SnapshotFile)
+    bool writeSnapshot(uint64_t id) const {
+        SnapshotWriter w;
+        size_t userCount = friendGraph.nodeCount();
+        for (uint32_t user = 0; user < userCount; ++user) {
+            const User* u = userHash.search(friendGraph.usernameOf(user));
+            w.users.push_back(SnapshotUser{w.add(u->userID), w.add(u->username), w.add(u->password)});
+        }
+
+        userPosts.forEach([&](const string&, const PostLog& log) {
+            for (size_t slot = 0; slot < log.slotCount(); ++slot) {
+                const Post* p = log.at(slot);
+                if (!p) continue;
+                SnapshotPost rec;
+                rec.postID = w.add(p->postID);
+                rec.author = w.add(p->authorUsername);
+                rec.content = w.add(p->content);
+                rec.firstComment = w.comments.size();
+                forEachStoredComment(p->postID, [&](const Comment& c) {
+                    w.commentKeys.push_back(SnapshotCommentKey{idNumber(c.commentID), w.posts.size(),
+                                                               w.comments.size() - rec.firstComment});
+                    w.comments.push_back(SnapshotComment{w.add(c.commentID), w.add(c.authorUsername),
+                                                         w.add(c.content), w.add(c.parentCommentID)});
+                });
+                rec.commentCount = w.comments.size() - rec.firstComment;
+                rec.firstLiker = w.likers.size();
+                LikerSet* likers = postLikes.search(p->postID);
+                if (likers) forEachLiker(p->postID, *likers, [&](uint32_t userId) { w.likers.push_back(userId); });
+                rec.likerCount = w.likers.size() - rec.firstLiker;
+                rec.likeCount = getLikeCount(p->postID);
+                w.posts.push_back(rec);
+            }
+        });
+
+        vector<uint32_t> row;
+        for (uint32_t user = 0; user < userCount; ++user) {
+            friendGraph.snapshot().sortedNeighbours(user, row);
+            w.friendIds.insert(w.friendIds.end(), row.begin(), row.end());
+            w.friendOffsets.push_back(w.friendIds.size());
+        }
+        return w.write(SNAPSHOT_FILE, id, maxUserID, maxPostID, maxCommentID);
+    }
+
+    // Where a checkpoint writes the log that will follow snapshot `id`
+    string freshWalFile(uint64_t id) const { return WAL_FILE + "." + to_string(id); }
+
+    // Replays the log written since the loaded snapshot and keeps appending
+    // to it. If a checkpoint never renamed its fresh log, that log is the
+    // one to replay. A log of an older checkpoint is set aside, as the
+    // snapshot holds its records; any other log stops startup. A text
+    // import has no snapshot for a log to follow, so it is checkpointed
+    // first, and a log found then belongs to a snapshot that went missing.
+    void recoverFromWal(bool fromSnapshot) {
+        if (!fromSnapshot) {
+            if (fileExists(WAL_FILE)) throw runtime_error(WAL_FILE + " has no " + SNAPSHOT_FILE + " to follow");
+            if (!checkpoint()) throw runtime_error("Could not write " + SNAPSHOT_FILE);
+            return;
+        }
+        uint64_t validBytes = 0;
+        auto apply = [this](const WalRecord& r) { replayRecord(r); };
+        walPath = WAL_FILE;
+        WalReplay replay = WriteAheadLog::replay(walPath, checkpointId, apply, validBytes);
+        if (replay == WalReplay::Missing || replay == WalReplay::Superseded) {
+            string fresh = freshWalFile(checkpointId);
+            if (WriteAheadLog::replay(fresh, checkpointId, apply, validBytes) == WalReplay::Replayed) {
+                walPath = fresh;
+                replay = WalReplay::Replayed;
+            }
+        }
+        if (replay == WalReplay::Foreign) throw runtime_error(WAL_FILE + " does not follow " + SNAPSHOT_FILE);
+        if (replay == WalReplay::Replayed) {
+            flushLikes();
+            if (!wal.openAt(walPath, validBytes)) throw runtime_error("Could not open " + walPath);
+            return;
+        }
+        if (replay == WalReplay::Superseded) replaceFile(WAL_FILE, WAL_FILE + ".orphan");
+        if (!wal.reset(WAL_FILE, checkpointId)) throw runtime_error("Could not write " + WAL_FILE);
+    }
+
+    bool replayRecord(const WalRecord& r) {
+        const vector<string>& f = r.fields;
+        switch (r.op) {
+        case WalOp::RegisterUser: return f.size() == 3 && applyRegisterUser(f[0], f[1], f[2]);
+        case WalOp::CreatePost: return f.size() == 3 && applyCreatePost(f[0], f[1], f[2]);
+        case WalOp::EditPost: return f.size() == 3 && applyEditPost(f[0], f[1], f[2]);
+        case WalOp::DeletePost: return f.size() == 2 && applyDeletePost(f[0], f[1]);
+        case WalOp::AddComment: return f.size() == 4 && applyAddComment(f[0], f[1], f[2], f[3]);
+        case WalOp::AddReply: return f.size() == 4 && applyAddReply(f[0], f[1], f[2], f[3]);
+        case WalOp::ToggleLike: return f.size() == 2 && applyToggleLike(f[0], f[1]);
+        case WalOp::AddFriend: return f.size() == 2 && applyAddFriend(f[0], f[1]);
+        case WalOp::RemoveFriend: return f.size() == 2 && applyRemoveFriend(f[0], f[1]);
+        }
+        return false;
+    }
+
+    // Queues a record for the next group commit
+    void logMutation(WalOp op, initializer_list<string> fields) {
+        wal.append(op, fields);
+        if (wal.isDue()) syncWal();
+    }
+
+    // --- Mutations. Each applyX() changes state on behalf of `actor` and
+    // is shared by the public entry point, which logs it, and WAL replay.
+
+    void noteID(const string& id, char prefix, int& maxID) const {
+        int n = extractID(id, prefix);
+        if (n > maxID) maxID = n;
+    }
+
+    bool applyRegisterUser(const string& userID, const string& username, const string& password) {
+        if (userHash.search(username)) return false;
+        noteID(userID, 'U', maxUserID);
+        // Growing the table relocates entries, so re-resolve the session pointer
+        string sessionUser = currentUsername();
+        userHash.insert(username, User(userID, username, password));
+        friendGraph.addNode(username);
+        if (!sessionUser.empty()) currentUser = userHash.search(sessionUser);
+        return true;
+    }
+
+    bool applyCreatePost(const string& actor, const string& pid, const string& content) {
+        if (!userHash.search(actor) || postIndex.search(pid)) return false;
+        noteID(pid, 'P', maxPostID);
+        PostLog& log = postLogFor(actor);
+        size_t slot = log.append(Post(pid, actor, content));
+        PostRef ref;
+        ref.record = log.at(slot);
+        ref.slot = slot;
+        postIndex.insert(pid, ref);
+        long long number = ref.record->number();
+        postTimeline.insert(number, ref.record);
+        postLikes.insert(pid, LikerSet());
+        bumpPostsVersion(actor);
+        if (feedMode == FeedMode::FanOut) {
+            for (const string& reader : feedAudience(actor)) inboxFor(reader).push(number);
+        }
+        return true;
+    }
+
+    bool applyAddComment(const string& actor, const string& cid, const string& postID, const string& text) {
+        if (!postIndex.search(postID)) return false;
+        commentsFor(postID); // any comments still in the snapshot go first
+        noteID(cid, 'C', maxCommentID);
+        appendComment(commentLogFor(postID), Comment(cid, postID, actor, text));
+        return true;
+    }
+
+    bool applyAddReply(const string& actor, const string& cid, const string& parentCommentID, const string& text) {
+        CommentRef* parent = findComment(parentCommentID);
+        if (!parent) return false;
+        string postID = parent->postID;
+        CommentLog* comments = commentsFor(postID);
+        if (!comments) return false;
+        noteID(cid, 'C', maxCommentID);
+        appendComment(*comments, Comment(cid, postID, actor, text, parentCommentID));
+        return true;
+    }
+
+    bool applyToggleLike(const string& actor, const string& postID) {
+        LikerSet* likers = postLikes.search(postID);
+        uint32_t userId;
+        if (!likers || !friendGraph.userId(actor, userId)) return false;
+        // Buffered; applied by flushLikes() once the window or batch fills
+        likeBatcher.record(postID, userId, !likedBy(postID, *likers, userId));
+        if (likeBatcher.isFull()) flushLikes();
+        return true;
+    }
+
+    bool applyAddFriend(const string& a, const string& friendUsername) {
+        if (a == friendUsername) return false;
+        if (!userHash.search(a) || !userHash.search(friendUsername)) return false;
+        if (!friendGraph.addEdge(a, friendUsername)) return false; // already friends
+        ++edgesChangedSinceReach;
+        vector<string> friendsOfA = friendGraph.getFriends(a);
+        vector<string> friendsOfB = friendGraph.getFriends(friendUsername);
+        invalidateNeighbourhood(a, friendUsername, friendsOfA, friendsOfB);
+        if (feedMode == FeedMode::FanOut) {
+            // New pairs within two hops: (a, b), (a, friends of b), (b, friends of a)
+            backfillPair(a, friendUsername);
+            for (const string& y : friendsOfB) if (y != a) backfillPair(a, y);
+            for (const string& x : friendsOfA) if (x != friendUsername) backfillPair(friendUsername, x);
+        }
+        return true;
+    }
+
+    bool applyRemoveFriend(const string& a, const string& friendUsername) {
+        if (!friendGraph.isFriend(a, friendUsername)) return false;
+        vector<string> friendsOfA = friendGraph.getFriends(a);
+        vector<string> friendsOfB = friendGraph.getFriends(friendUsername);
+        friendGraph.removeEdge(a, friendUsername);
+        ++edgesChangedSinceReach;
+        invalidateNeighbourhood(a, friendUsername, friendsOfA, friendsOfB);
+        if (feedMode == FeedMode::FanOut) {
+            // Only pairs that relied on the removed edge can fall out of reach
+            retractPair(a, friendUsername);
+            for (const string& y : friendsOfB) retractPair(a, y);
+            for (const string& x : friendsOfA) retractPair(friendUsername, x);
+        }
+        return true;
+    }
+
+    bool applyEditPost(const string& actor, const string& postID, const string& newContent) {
+        PostRef* ref = postIndex.search(postID);
+        if (!ref || ref->record->authorUsername != actor) return false;
+        ref->record->content = newContent; // the timeline points at this record
+        bumpPostsVersion(actor);
+        return true;
+    }
+
+    bool applyDeletePost(const string& actor, const string& postID) {
+        PostRef* ref = postIndex.search(postID);
+        if (!ref || ref->record->authorUsername != actor) return false;
+        PostLog* log = userPosts.search(actor);
+        if (!log) return false;
+        size_t slot = ref->slot;
+        postIndex.remove(postID);
+        postTimeline.erase(idNumber(postID));
+        if (log->remove(slot)) indexPostLog(*log); // compaction moved records
+        CommentLog* comments = postComments.search(postID);
+        if (comments) comments->forEach([&](const Comment& c) { commentIndex.remove(c.commentID); });
+        postComments.remove(postID);
+        unloadedComments.remove(postID);
+        postLikes.remove(postID);
+        likeBatcher.drop(postID);
+        bumpPostsVersion(actor);
+        return true;
+    }
+
+public:
+    // Starts from the binary snapshot when there is one (otherwise the text
+    // files), then replays the write-ahead log on top. Throws runtime_error
+    // rather than start over a snapshot or log it can't account for.
+    SocialMediaSystem() {
+        bool fromSnapshot = loadSnapshot();
+        if (!fromSnapshot) loadDataInternal();
+        recoverFromWal(fromSnapshot);
+    }
+    // Shutdown only has to sync the log's last group
+    ~SocialMediaSystem() { syncWal(); }
+
+    // Writes and fsyncs the pending group of log records; once the log has
+    // grown past WAL_CHECKPOINT_BYTES it is folded into a new snapshot.
+    // Without an open log, checkpointing is the only way to make the
+    // pending changes durable. False if the changes are not yet on disk.
+    bool syncWal() {
+        if (!wal.isOpen()) return checkpoint();
+        bool ok = wal.sync();
+        if (wal.size() > WAL_CHECKPOINT_BYTES) ok = checkpoint() && ok;
+        return ok;
+    }
+
+    // Periodic driver: syncs only when the group-commit window has elapsed.
+    // False if that sync failed; the records stay pending for the next try.
+    bool syncWalIfDue() {
+        if (!wal.isDue()) return true;
+        return syncWal();
+    }
+
+    // Writes a snapshot of the current state and starts an empty log after
+    // it. The new log is created first and the current one stays in use
+    // until the snapshot is durable. A crash after that leaves a log naming
+    // the old checkpoint, which recovery sets aside; if the new log can't
+    // be renamed into place, it is used under its own name, where recovery
+    // also looks, and the next checkpoint tries the rename again. True once
+    // the snapshot and the new log are both durable.
+    // Runs on the caller's thread and writes the whole dataset: from the
+    // GUI that is a stall of about a second per 200k posts and 1M comments.
+    bool checkpoint() {
+        uint64_t next = checkpointId + 1;
+        string fresh = freshWalFile(next);
+        if (!WriteAheadLog::create(fresh, next)) return false;
+        if (!writeSnapshot(next)) { std::remove(fresh.c_str()); return false; }
+        checkpointId = next;
+        string previous = walPath;
+        walPath = replaceFile(fresh, WAL_FILE) ? WAL_FILE : fresh;
+        if (!wal.switchTo(walPath)) { wal.close(); return false; }
+        if (!previous.empty() && previous != WAL_FILE && previous != walPath) std::remove(previous.c_str());
+        return true;
+    }
+
+    uint64_t walSize() const { return wal.size(); }
+
+    // On-demand text export in the import format. The app never calls it:
+    // past the first launch the snapshot and log hold the data, and the
+    // text files are left as they were imported.
+    void saveData() const {
+        ofstream userFile(USERS_FILE);
+        userHash.forEach([&](const string&, const User& u) { userFile << u.toString() << "\n"; });
+        userFile.close();
+
+        ofstream postFile(POSTS_FILE);
+        userPosts.forEach([&](const string&, const PostLog& log) {
+            // Oldest first, so reloading is a plain sequence of appends
+            for (size_t i = 0; i < log.slotCount(); ++i) {
+                const Post* p = log.at(i);
+                if (p) postFile << p->toString(getLikeCount(p->postID)) << "\n";
+            }
+        });
+        postFile.close();
+
+        ofstream commentFile(COMMENTS_FILE);
+        userPosts.forEach([&](const string&, const PostLog& log) {
+            log.forEach([&](size_t, const Post& p) {
+                forEachStoredComment(p.postID, [&](const Comment& c) { commentFile << c.toString() << "\n"; });
+            });
+        });
+        commentFile.close();
+
+        ofstream likeFile(LIKES_FILE);
+        postLikes.forEach([&](const string& postID, const LikerSet& likers) {
+            forEachLiker(postID, likers, [&](uint32_t userId) {
+                likeFile << postID << "|" << friendGraph.usernameOf(userId) << "\n";
+            });
+        });
+        likeFile.close();
+
+        ofstream friendFile(FRIENDS_FILE);
+        const CsrGraph& friendRows = friendGraph.snapshot();
+        for (uint32_t u = 0; u < friendGraph.nodeCount(); ++u) {
+            // Each edge is in both rows; write it once, from the smaller ID
+            friendRows.forEachNeighbour(u, [&](uint32_t v) {
+                if (u < v) friendFile << friendGraph.usernameOf(u) << "|" << friendGraph.usernameOf(v) << "\n";
+            });
+        }
+        friendFile.close();
+    }
+
+    bool userRegistration(const string& username, const string& password) {
+        if (userHash.search(username)) return false;
+        string newID = generateUserID();
+        applyRegisterUser(newID, username, password);
+        logMutation(WalOp::RegisterUser, {newID, username, password});
+        return true;
+    }
+    bool userLogin(const string& username, const string& password) {
+        User* u = userHash.search(username);
         if (u && u->password == password) { currentUser = u; return true; }
         return false;
     }
@@ -766,63 +3765,157 @@ public:
     bool createPost(const string& content) {
         if (!currentUser) return false;
         string pid = generatePostID();
-        Post p(pid, currentUser->username, content);
-        SinglyLinkedList_Post* postsList = userPosts.search(currentUser->username);
-        if (!postsList) { userPosts.insert(currentUser->username, SinglyLinkedList_Post()); postsList = userPosts.search(currentUser->username); }
-        postsList->insertAtEnd(p);
-        allPostsBST.insert(p);
-        postComments.insert(pid, SimpleQueue_Comment());
-        postLikes.insert(pid, SimpleStack_String());
+        if (!applyCreatePost(currentUser->username, pid, content)) return false;
+        logMutation(WalOp::CreatePost, {currentUser->username, pid, content});
         return true;
     }
 
-    vector<Post> getAllPosts() const { return allPostsBST.toVectorInOrder(); }
+    vector<Post> getAllPosts() const {
+        vector<Post> out;
+        out.reserve(postTimeline.size());
+        for (SkipListNode<Post*>* n = postTimeline.first(); n; n = n->forward[0]) out.push_back(*n->data);
+        return out;
+    }
     vector<Post> getPostsByUser(const string& username) const {
-        SinglyLinkedList_Post* list = userPosts.search(username);
-        if (!list) return {};
-        return list->toVector();
+        PostLog* log = userPosts.search(username);
+        if (!log) return {};
+        return log->toVector();
     }
 
     bool addComment(const string& postID, const string& text) {
-        if (!currentUser) return false;
-        SimpleQueue_Comment* q = postComments.search(postID);
-        if (!q) return false;
+        if (!currentUser || !postIndex.search(postID)) return false;
+        string cid = generateCommentID();
+        if (!applyAddComment(currentUser->username, cid, postID, text)) return false;
+        logMutation(WalOp::AddComment, {currentUser->username, cid, postID, text});
+        return true;
+    }
+
+    bool addReply(const string& parentCommentID, const string& text) {
+        if (!currentUser || !findComment(parentCommentID)) return false;
         string cid = generateCommentID();
-        q->enqueue(Comment(cid, postID, currentUser->username, text));
+        if (!applyAddReply(currentUser->username, cid, parentCommentID, text)) return false;
+        logMutation(WalOp::AddReply, {currentUser->username, cid, parentCommentID, text});
         return true;
     }
 
-    vector<Comment> getComments(const string& postID) const {
-        SimpleQueue_Comment* q = postComments.search(postID);
-        if (!q) return {};
-        return q->toVector();
+    // Oldest first; reads only comments [offset, offset + limit)
+    vector<Comment> getComments(const string& postID, size_t offset = 0,
+                                size_t limit = numeric_limits<size_t>::max()) const {
+        CommentLog* comments = commentsFor(postID);
+        if (!comments) return {};
+        return comments->range(offset, limit);
+    }
+
+    size_t getCommentCount(const string& postID) const {
+        size_t* pending = unloadedComments.search(postID);
+        if (pending) {
+            // Counting doesn't need the comments themselves
+            size_t postCount;
+            return snapshotFile.records<SnapshotPost>(SnapshotPart::Posts, postCount)[*pending].commentCount;
+        }
+        CommentLog* comments = postComments.search(postID);
+        return comments ? comments->size() : 0;
+    }
+
+    // Threaded view: top-level comments first, replies fetched per comment
+    vector<Comment> getTopLevelComments(const string& postID, size_t offset = 0,
+                                        size_t limit = numeric_limits<size_t>::max()) const {
+        CommentLog* comments = commentsFor(postID);
+        if (!comments) return {};
+        return comments->topLevelRange(offset, limit);
+    }
+
+    size_t getTopLevelCommentCount(const string& postID) const {
+        CommentLog* comments = commentsFor(postID);
+        return comments ? comments->topLevelCount() : 0;
+    }
+
+    vector<Comment> getReplies(const string& commentID, size_t offset = 0,
+                               size_t limit = numeric_limits<size_t>::max()) const {
+        CommentRef* ref = findComment(commentID);
+        if (!ref) return {};
+        CommentLog* comments = postComments.search(ref->postID);
+        if (!comments) return {};
+        return comments->repliesRange(ref->index, offset, limit);
+    }
+
+    size_t getReplyCount(const string& commentID) const {
+        CommentRef* ref = findComment(commentID);
+        if (!ref) return 0;
+        CommentLog* comments = postComments.search(ref->postID);
+        return comments ? comments->replyCount(ref->index) : 0;
     }
 
     bool toggleLike(const string& postID) {
-        if (!currentUser) return false;
-        SimpleStack_String* s = postLikes.search(postID);
-        if (!s) return false;
-        if (s->contains(currentUser->username)) { s->remove(currentUser->username); return true; }
-        else { s->push(currentUser->username); return true; }
+        if (!currentUser || !applyToggleLike(currentUser->username, postID)) return false;
+        logMutation(WalOp::ToggleLike, {currentUser->username, postID});
+        return true;
+    }
+
+    // Applies buffered toggles in one pass and publishes one count change
+    // per post whose count moved
+    void flushLikes() {
+        vector<pair<string, int>> changed;
+        likeBatcher.drain([&](const string& postID, const PendingLikes& p) {
+            LikerSet* likers = postLikes.search(postID);
+            if (!likers) return;
+            p.toggled.forEach([&](uint32_t userId) { likers->toggle(userId); });
+            if (p.delta != 0) changed.push_back({postID, likers->count()});
+        });
+        if (likeCountListener) {
+            for (const auto& c : changed) likeCountListener(c.first, c.second);
+        }
+    }
+
+    // Periodic driver: flushes only when the buffering window has elapsed
+    bool flushLikesIfDue() {
+        if (!likeBatcher.windowElapsed()) return false;
+        flushLikes();
+        return true;
     }
 
+    size_t pendingLikeCount() const { return likeBatcher.size(); }
+
+    void setLikeCountListener(function<void(const string&, int)> listener) { likeCountListener = std::move(listener); }
+
+    // Counts include toggles still in the batch
     int getLikeCount(const string& postID) const {
-        SimpleStack_String* s = const_cast<SimpleHashTable<string, SimpleStack_String>*>(&postLikes)->search(postID);
-        return s ? s->count() : 0;
+        LikerSet* likers = postLikes.search(postID);
+        if (!likers) return 0;
+        const PendingLikes* p = likeBatcher.find(postID);
+        return likers->count() + (p ? p->delta : 0);
     }
 
-    bool addFriend(const string& friendUsername) {
+    bool hasLiked(const string& postID) const {
         if (!currentUser) return false;
-        if (currentUser->username == friendUsername) return false;
-        if (!userHash.search(friendUsername)) return false;
-        if (friendGraph.isFriend(currentUser->username, friendUsername)) return false;
-        friendGraph.addEdge(currentUser->username, friendUsername);
+        LikerSet* likers = postLikes.search(postID);
+        uint32_t userId;
+        return likers && friendGraph.userId(currentUser->username, userId) && likedBy(postID, *likers, userId);
+    }
+
+    // "N of your friends liked this": bitmap AND of likers and the friend set
+    int getFriendLikeCount(const string& postID) const {
+        if (!currentUser) return 0;
+        LikerSet* likers = postLikes.search(postID);
+        if (!likers) return 0;
+        RoaringBitmap friends = friendGraph.friendBitmap(currentUser->username);
+        int count = likers->countAmong(friends);
+        const PendingLikes* p = likeBatcher.find(postID);
+        if (p) p->toggled.forEach([&](uint32_t userId) {
+            if (friends.contains(userId)) count += likers->contains(userId) ? -1 : 1;
+        });
+        return count;
+    }
+
+    bool addFriend(const string& friendUsername) {
+        if (!currentUser || !applyAddFriend(currentUser->username, friendUsername)) return false;
+        logMutation(WalOp::AddFriend, {currentUser->username, friendUsername});
         return true;
     }
 
     bool removeFriend(const string& friendUsername) {
-        if (!currentUser) return false;
-        friendGraph.removeEdge(currentUser->username, friendUsername);
+        if (!currentUser || !applyRemoveFriend(currentUser->username, friendUsername)) return false;
+        logMutation(WalOp::RemoveFriend, {currentUser->username, friendUsername});
         return true;
     }
 
@@ -836,6 +3929,115 @@ public:
         return friendGraph.suggestFriends(currentUser->username);
     }
 
+    // Best k second-degree contacts with their mutual-friend counts
+    vector<FriendSuggestion> getFriendSuggestions(size_t k = SUGGESTION_LIMIT,
+                                                  SuggestionScore mode = SuggestionScore::MutualFriends) const {
+        if (!currentUser) return {};
+        return friendGraph.rankSuggestions(currentUser->username, k, mode);
+    }
+
+    // Random-walk recommendations for the current user. Served from the
+    // last precompute when there is one (minus anyone befriended since),
+    // otherwise computed live within config's walk budget.
+    vector<FriendSuggestion> getRecommendations(size_t k = SUGGESTION_LIMIT,
+                                                const RandomWalkConfig& config = RandomWalkConfig()) const {
+        if (!currentUser) return {};
+        vector<FriendSuggestion>* cached = precomputedRecommendations.search(currentUser->username);
+        if (!cached) return friendGraph.recommendByRandomWalk(currentUser->username, k, config);
+        vector<FriendSuggestion> out;
+        for (const FriendSuggestion& fs : *cached) {
+            if (out.size() == k) break;
+            if (!friendGraph.isFriend(currentUser->username, fs.username)) out.push_back(fs);
+        }
+        return out;
+    }
+
+    // Batch job over all cores: replaces the stored recommendations for
+    // every user. Returns the number of users covered.
+    size_t precomputeRecommendations(size_t k = SUGGESTION_LIMIT, const RandomWalkConfig& config = RandomWalkConfig()) {
+        vector<vector<FriendSuggestion>> all = friendGraph.recommendForAll(k, config);
+        precomputedRecommendations.clear();
+        for (size_t id = 0; id < all.size(); ++id) {
+            precomputedRecommendations.insert(friendGraph.usernameOf(static_cast<uint32_t>(id)), std::move(all[id]));
+        }
+        return all.size();
+    }
+
+    // Hops between the current user and `username`, -1 if further than maxDepth
+    int getDegreesOfSeparation(const string& username, int maxDepth = SEPARATION_MAX_DEPTH) const {
+        if (!currentUser) return -1;
+        return friendGraph.degreesOfSeparation(currentUser->username, username, maxDepth);
+    }
+
+    // "How you're connected": current user first, `username` last
+    bool getConnectionPath(const string& username, vector<string>& outPath,
+                           int maxDepth = SEPARATION_MAX_DEPTH) const {
+        if (!currentUser) return false;
+        return friendGraph.shortestPath(currentUser->username, username, outPath, maxDepth);
+    }
+
+    // Rebuilds the per-hop reach sketches over all cores and waits for
+    // them; for batch jobs. Interactive callers use the background driver.
+    void refreshReachEstimates() {
+        if (reachBuild.valid()) reachBuild.get(); // superseded by this build
+        reachStartedAt = chrono::steady_clock::now();
+        edgesChangedSinceReach = 0;
+        ReachIndex index;
+        index.build(friendGraph);
+        adoptReachIndex(std::move(index));
+    }
+    bool reachEstimatesStale() const { return !reachBuilt || edgesChangedSinceReach > 0; }
+
+    // Starts a rebuild on a worker thread over a copy of the friend graph,
+    // so mutations carry on meanwhile; false if one is already running
+    bool startReachRefresh() {
+        if (reachBuild.valid()) return false;
+        CsrGraph rows = friendGraph.snapshot();
+        size_t n = friendGraph.nodeCount();
+        reachBuild = async(launch::async, [rows = std::move(rows), n]() {
+            ReachIndex index;
+            index.build(rows, n);
+            return index;
+        });
+        reachStartedAt = chrono::steady_clock::now();
+        edgesChangedSinceReach = 0;
+        return true;
+    }
+
+    // Periodic driver: adopts a finished background build, then starts
+    // the next one once the estimates are stale and the last build began
+    // REACH_REFRESH_INTERVAL_MS ago. True if new estimates were adopted.
+    bool refreshReachEstimatesIfDue() {
+        bool adopted = false;
+        if (reachBuild.valid() && reachBuild.wait_for(chrono::seconds(0)) == future_status::ready) {
+            adoptReachIndex(reachBuild.get());
+            adopted = true;
+        }
+        bool intervalOver = !reachBuilt
+            || chrono::steady_clock::now() - reachStartedAt >= chrono::milliseconds(REACH_REFRESH_INTERVAL_MS);
+        if (!reachBuild.valid() && reachEstimatesStale() && intervalOver) startReachRefresh();
+        return adopted;
+    }
+
+    // ~people `username` can reach within `hops` hops (1..REACH_MAX_HOPS),
+    // as of the last finished build; false before the first one and for
+    // users registered since
+    bool getReachEstimate(const string& username, int hops, double& outEstimate) const {
+        uint32_t id;
+        return friendGraph.userId(username, id) && reachIndex.reach(id, hops, outEstimate);
+    }
+
+    // Pull once the average post audience (two-hop reach) is too wide to
+    // copy into every inbox
+    FeedMode recommendedFeedMode() const {
+        return reachIndex.averageReach(2) > FANOUT_AUDIENCE_LIMIT ? FeedMode::Pull : FeedMode::FanOut;
+    }
+
+    size_t getMutualFriendCount(const string& username) const {
+        if (!currentUser) return 0;
+        return friendGraph.mutualFriendCount(currentUser->username, username);
+    }
+
     bool searchUser(const string& username, User& outUser) const {
         User* u = userHash.search(username);
         if (!u) return false;
@@ -848,65 +4050,173 @@ public:
         return p.postID + " | " + p.authorUsername + "\n" + p.content + "\nLikes: " + to_string(likes);
     }
 
+    string postSummary(const PostView& v) const {
+        string likes = to_string(v.likeCount);
+        if (v.friendLikeCount > 0) likes += " (" + to_string(v.friendLikeCount) + " from your friends)";
+        return v.postID + " | " + v.authorUsername + "\n" + v.content + "\nLikes: " + likes
+               + "\nComments: " + to_string(v.commentCount);
+    }
+
+    // O(1) lookup by post ID; nullptr if the post does not exist.
+    const Post* getPost(const string& postID) const {
+        PostRef* ref = postIndex.search(postID);
+        return ref ? ref->record : nullptr;
+    }
+
+    bool getPostView(const string& postID, PostView& outView) const {
+        const Post* p = getPost(postID);
+        if (!p) return false;
+        outView.postID = p->postID;
+        outView.authorUsername = p->authorUsername;
+        outView.content = p->content;
+        outView.likeCount = getLikeCount(postID);
+        outView.friendLikeCount = getFriendLikeCount(postID);
+        outView.commentCount = static_cast<int>(getCommentCount(postID));
+        return true;
+    }
+
     bool editPost(const string& postID, const string& newContent) {
-        if (!currentUser) return false;
-        SinglyLinkedList_Post* list = userPosts.search(currentUser->username);
-        if (!list) return false;
-        bool ok = list->editByPostID(postID, newContent);
-        if (ok) { const_cast<SocialMediaSystem*>(this)->rebuildAllPostsBST(); return true; }
-        return false;
+        if (!currentUser || !applyEditPost(currentUser->username, postID, newContent)) return false;
+        logMutation(WalOp::EditPost, {currentUser->username, postID, newContent});
+        return true;
     }
 
     bool deletePost(const string& postID) {
-        if (!currentUser) return false;
-        SinglyLinkedList_Post* list = userPosts.search(currentUser->username);
-        if (!list) return false;
-        bool ok = list->removeByPostID(postID);
-        if (ok) { const_cast<SocialMediaSystem*>(this)->rebuildAllPostsBST(); return true; }
-        return false;
+        if (!currentUser || !applyDeletePost(currentUser->username, postID)) return false;
+        logMutation(WalOp::DeletePost, {currentUser->username, postID});
+        return true;
     }
 
     // --- IMPROVED FOR YOU FEED ALGORITHM ---
     // Returns posts from all friends (and suggestions) ordered NEWEST first.
     vector<Post> getFeedPosts() const {
-        if (!currentUser) return {};
-
-        // 1. Get ALL posts from the BST, but in REVERSE order (Newest -> Oldest)
-        // This ensures the feed looks correct time-wise.
-        vector<Post> allPosts = allPostsBST.toVectorReverseInOrder();
-        vector<Post> filteredFeed;
+        return getFeedPage("", numeric_limits<size_t>::max()).posts;
+    }
 
-        // 2. Build quick lookup tables for friends and suggestions
-        SimpleHashTable<string, bool> allowedAuthors;
+    // Returns up to `limit` feed posts older than `cursor` (newest first).
+    // Pass an empty cursor for the first page, then the previous page's
+    // nextCursor. The timeline scan stops as soon as the page is full, so the
+    // cost depends on the page size rather than on the total number of posts.
+    FeedPage getFeedPage(const string& cursor = "", size_t limit = FEED_PAGE_SIZE) const {
+        if (!currentUser || limit == 0) return FeedPage();
+        const string& me = currentUser->username;
+        string key = me + "|" + cursor + "|" + to_string(limit);
+        CachedFeedPage* cached = feedCache.get(key);
+        if (cached && isCurrent(*cached, me)) { ++feedCacheHits; return cached->page; }
+        ++feedCacheMisses;
 
-        // Add Friends (Priority 1)
-        AdjacencyList* friendsList = const_cast<Graph*>(&friendGraph)->getNodesTable()->search(currentUser->username);
-        if (friendsList) {
-            LinkNode* curr = friendsList->head;
-            while(curr) {
-                allowedAuthors.insert(curr->username, true);
-                curr = curr->next;
-            }
+        CachedFeedPage fresh;
+        fresh.version = feedVersion(me);
+        vector<string> authors = feedAudience(me);
+        fresh.page = (feedMode == FeedMode::FanOut) ? inboxFeedPage(cursor, limit) : pullFeedPage(authors, cursor, limit);
+        fresh.authors.reserve(authors.size());
+        for (string& a : authors) {
+            unsigned long long v = postsVersion(a);
+            fresh.authors.emplace_back(std::move(a), v);
         }
+        feedCache.put(key, fresh);
+        return fresh.page;
+    }
 
-        // Add Suggestions (Priority 2) - helps discovery
-        vector<string> suggestions = friendGraph.suggestFriends(currentUser->username);
-        for(const string& s : suggestions) {
-            allowedAuthors.insert(s, true);
-        }
+    // --- RANKED FOR YOU FEED ---
+    // Scores recent posts from friends and second-degree contacts by recency
+    // decay, likes, comments and graph distance, and keeps only the best k in
+    // a bounded min-heap instead of sorting every candidate.
+    vector<RankedPost> getRankedFeed(size_t k = FEED_PAGE_SIZE) const {
+        vector<RankedPost> out;
+        if (!currentUser || k == 0) return out;
+        const string& me = currentUser->username;
 
-        // 3. Filter the sorted posts
-        for(const Post& p : allPosts) {
-            // Exclude own posts
-            if (p.authorUsername == currentUser->username) continue;
+        // 1. Gather a compact candidate array (post pointer + raw signals)
+        class Candidate {
+        public:
+            const Post* post;
+            long long number;
+            uint32_t likes;
+            uint32_t comments;
+            double distanceWeight;
+        };
+        vector<Candidate> candidates;
+        auto gather = [&](const vector<string>& authors, double distanceWeight) {
+            for (const string& author : authors) {
+                if (author == me) continue;
+                PostLog* log = userPosts.search(author);
+                if (!log) continue;
+                size_t taken = 0;
+                for (long long i = log->newestSlot(); i >= 0 && taken < rankingWeights.perAuthorWindow; i = log->previousSlot(i), ++taken) {
+                    const Post* p = log->at(i);
+                    candidates.push_back(Candidate{p, p->number(),
+                                                   static_cast<uint32_t>(getLikeCount(p->postID)),
+                                                   static_cast<uint32_t>(getCommentCount(p->postID)), distanceWeight});
+                }
+            }
+        };
+        gather(friendGraph.getFriends(me), rankingWeights.friendWeight);
+        gather(friendGraph.suggestFriends(me), rankingWeights.suggestionWeight);
+        if (candidates.empty()) return out;
 
-            // Include if author is in our allowed list (Friend or Suggestion)
-            if (allowedAuthors.search(p.authorUsername)) {
-                filteredFeed.push_back(p);
+        // 2. Score each slice into its own top-k heap (min score on top)
+        typedef pair<double, size_t> Scored;
+        auto worse = [](const Scored& a, const Scored& b) { return a.first > b.first; };
+        const RankingWeights w = rankingWeights;
+        const double newest = static_cast<double>(maxPostID);
+        size_t chunks = candidates.size() >= PARALLEL_RANK_THRESHOLD
+                            ? parallelChunks(candidates.size(), PARALLEL_RANK_THRESHOLD / 4) : 1;
+        vector<vector<Scored>> heaps(chunks);
+        parallelFor(candidates.size(), chunks, [&](size_t begin, size_t end, size_t chunk) {
+            vector<Scored>& heap = heaps[chunk];
+            heap.reserve(k + 1);
+            for (size_t i = begin; i < end; ++i) {
+                const Candidate& c = candidates[i];
+                double age = newest - static_cast<double>(c.number);
+                double recency = pow(0.5, age / w.halfLifePosts);
+                double engagement = 1.0 + w.likeWeight * log1p(c.likes) + w.commentWeight * log1p(c.comments);
+                double score = recency * engagement * c.distanceWeight;
+                if (heap.size() < k) { heap.push_back(Scored(score, i)); push_heap(heap.begin(), heap.end(), worse); }
+                else if (score > heap.front().first) {
+                    pop_heap(heap.begin(), heap.end(), worse);
+                    heap.back() = Scored(score, i);
+                    push_heap(heap.begin(), heap.end(), worse);
+                }
             }
+        });
+
+        // 3. Merge the per-slice heaps (at most chunks * k entries)
+        vector<Scored> best;
+        for (const vector<Scored>& heap : heaps) best.insert(best.end(), heap.begin(), heap.end());
+        sort(best.begin(), best.end(), [&](const Scored& a, const Scored& b) {
+            if (a.first != b.first) return a.first > b.first;
+            return candidates[a.second].number > candidates[b.second].number;
+        });
+        if (best.size() > k) best.resize(k);
+        for (const Scored& sc : best) {
+            RankedPost rp;
+            rp.post = *candidates[sc.second].post;
+            rp.score = sc.first;
+            out.push_back(rp);
         }
-        return filteredFeed;
+        return out;
+    }
+
+    void setRankingWeights(const RankingWeights& weights) { rankingWeights = weights; }
+    RankingWeights getRankingWeights() const { return rankingWeights; }
+
+    FeedCacheStats getFeedCacheStats() const {
+        FeedCacheStats stats;
+        stats.hits = feedCacheHits;
+        stats.misses = feedCacheMisses;
+        stats.evictions = feedCache.evictionCount();
+        stats.entries = feedCache.size();
+        return stats;
+    }
+
+    // Fixes the feed mode; reach builds no longer switch it (see
+    // adoptReachIndex)
+    void setFeedMode(FeedMode mode) {
+        feedModePinned = true;
+        switchFeedMode(mode);
     }
+    FeedMode getFeedMode() const { return feedMode; }
 };
 
 #endif // BACKEND_SOCIAL_MEDIA__H
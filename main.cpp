@@ -1,4 +1,5 @@
 #include <QApplication>
+#include <QMessageBox>
 #include "mainwindow.h"
 
 int main(int argc, char *argv[]) {
@@ -30,7 +31,13 @@ int main(int argc, char *argv[]) {
     QApplication::setOrganizationName("MyCompany");
     QApplication::setApplicationVersion("1.0");
 
-    MainWindow w;
-    w.show();
-    return a.exec();
+    // The backend refuses to start over data it can't account for
+    try {
+        MainWindow w;
+        w.show();
+        return a.exec();
+    } catch (const std::runtime_error& e) {
+        QMessageBox::critical(nullptr, "Startup Failed", e.what());
+        return 1;
+    }
 }
@@ -11,6 +11,7 @@
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QFrame>
+#include <QTreeWidget>
 #include <set>
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
@@ -71,8 +72,13 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     logoutBtn = new QPushButton("Logout");
     connect(logoutBtn, &QPushButton::clicked, this, &MainWindow::onLogoutClicked);
 
+    rankedToggleBtn = new QPushButton("Top Posts");
+    rankedToggleBtn->setCheckable(true);
+    connect(rankedToggleBtn, &QPushButton::toggled, this, &MainWindow::onRankedToggled);
+
     topBarLayout->addWidget(feedLabel);
     topBarLayout->addStretch();
+    topBarLayout->addWidget(rankedToggleBtn);
     topBarLayout->addWidget(logoutBtn);
 
     // Feed and post details
@@ -88,6 +94,10 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 
     connect(feedList, &QListWidget::itemSelectionChanged, this, &MainWindow::onPostSelected);
 
+    loadMoreBtn = new QPushButton("Load More");
+    loadMoreBtn->setVisible(false);
+    connect(loadMoreBtn, &QPushButton::clicked, this, &MainWindow::onLoadMoreClicked);
+
     // Right side buttons (Legacy/Backup interactions)
     likeBtn = new QPushButton("Toggle Like (Selected)");
     addCommentBtn = new QPushButton("Add Comment (Selected)");
@@ -110,6 +120,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     QVBoxLayout* leftLayout = new QVBoxLayout();
     leftLayout->addWidget(new QLabel("<b>Feed:</b>"));
     leftLayout->addWidget(feedList);
+    leftLayout->addWidget(loadMoreBtn);
     leftWidget->setLayout(leftLayout);
 
     QWidget* rightWidget = new QWidget();
@@ -147,17 +158,50 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     mainPage->setLayout(mainPageLayout);
     stackedWidget->addWidget(mainPage); // Index 1
 
+    // Like toggles are batched in the backend; flush them on a short timer
+    backend.setLikeCountListener([this](const string& postID, int) {
+        refreshLikeButton(postID);
+        if (selectedPostID() == QString::fromStdString(postID)) onPostSelected();
+    });
+    likeFlushTimer = new QTimer(this);
+    connect(likeFlushTimer, &QTimer::timeout, this, [this]() { backend.flushLikesIfDue(); });
+    likeFlushTimer->start(LIKE_FLUSH_WINDOW_MS);
+    walSyncTimer = new QTimer(this);
+    connect(walSyncTimer, &QTimer::timeout, this, [this]() {
+        if (backend.syncWalIfDue()) { walSyncFailing = false; return; }
+        if (walSyncFailing) return;
+        walSyncFailing = true; // set first: the timer keeps firing under the message box
+        QMessageBox::warning(this, "Save Failed",
+                             "Recent changes could not be written to disk and will be retried. "
+                             "Changes made until then may be lost if the app closes.");
+    });
+    walSyncTimer->start(WAL_GROUP_COMMIT_MS);
+    reachRefreshTimer = new QTimer(this);
+    connect(reachRefreshTimer, &QTimer::timeout, this, [this]() { backend.refreshReachEstimatesIfDue(); });
+    reachRefreshTimer->start(REACH_POLL_MS);
+
     // Initial state
     updateUiForAuth();
 }
 
-MainWindow::~MainWindow() {}
+MainWindow::~MainWindow() {
+    // The listener touches widgets, which are gone by the time backend saves
+    backend.setLikeCountListener(nullptr);
+}
 
 QString MainWindow::selectedPostID() const {
     auto sel = feedList->selectedItems();
     return sel.empty() ? QString() : sel.first()->data(Qt::UserRole).toString();
 }
 
+// Counts include toggles the backend is still batching
+void MainWindow::refreshLikeButton(const string& postID) {
+    QPushButton** btn = likeButtons.search(postID);
+    if (!btn) return;
+    QString label = backend.hasLiked(postID) ? "Liked (" : "Like (";
+    (*btn)->setText(label + QString::number(backend.getLikeCount(postID)) + ")");
+}
+
 void MainWindow::updateUiForAuth() {
     bool loggedIn = !backend.currentUsername().empty();
 
@@ -175,104 +219,20 @@ void MainWindow::updateUiForAuth() {
 // MODIFIED POPULATE FEED FUNCTION - ADDS BUTTONS TO EACH POST
 // ==========================================================
 void MainWindow::populateFeed() {
+    likeButtons.clear();
     feedList->clear();
+    feedCursor.clear();
+    loadMoreBtn->setVisible(false);
 
     if (backend.currentUsername().empty()) return;
 
-    // Get posts ordered Newest First
-    vector<Post> feedPosts = backend.getFeedPosts();
-
-    for (const Post& p : feedPosts) {
-        // 1. Create a custom widget to hold the post UI
-        QWidget* postWidget = new QWidget();
-        QVBoxLayout* postLayout = new QVBoxLayout(postWidget);
-        postLayout->setContentsMargins(10, 10, 10, 10);
-
-        // 2. Author Header
-        QLabel* authorLabel = new QLabel("<b>" + QString::fromStdString(p.authorUsername) + "</b>");
-        authorLabel->setStyleSheet("color: #2c3e50; font-size: 14px;");
-        postLayout->addWidget(authorLabel);
-
-        // 3. Post Content
-        QLabel* contentLabel = new QLabel(QString::fromStdString(p.content));
-        contentLabel->setWordWrap(true);
-        contentLabel->setStyleSheet("font-size: 13px; margin-top: 5px; margin-bottom: 5px;");
-        postLayout->addWidget(contentLabel);
-
-        // 4. Action Buttons Layout (Bottom of post)
-        QHBoxLayout* actionLayout = new QHBoxLayout();
-        actionLayout->setContentsMargins(0, 5, 0, 0);
-
-        int likeCount = backend.getLikeCount(p.postID);
-        QPushButton* itemLikeBtn = new QPushButton("Like (" + QString::number(likeCount) + ")");
-        itemLikeBtn->setCursor(Qt::PointingHandCursor);
-
-        QPushButton* itemCommentBtn = new QPushButton("Comment");
-        itemCommentBtn->setCursor(Qt::PointingHandCursor);
-
-        QPushButton* itemViewCommentsBtn = new QPushButton("View Comments");
-        itemViewCommentsBtn->setCursor(Qt::PointingHandCursor);
-
-        actionLayout->addWidget(itemLikeBtn);
-        actionLayout->addWidget(itemCommentBtn);
-        actionLayout->addWidget(itemViewCommentsBtn);
-        actionLayout->addStretch(); // Push buttons to the left
-
-        postLayout->addLayout(actionLayout);
-
-        // 5. Divider Line (Optional visual separation inside the item)
-        QFrame* line = new QFrame();
-        line->setFrameShape(QFrame::HLine);
-        line->setFrameShadow(QFrame::Sunken);
-        postLayout->addWidget(line);
-
-        // 6. Create the List Item
-        QListWidgetItem* item = new QListWidgetItem(feedList);
-        // Important: Set size hint so ListWidget knows how much space to allocate
-        item->setSizeHint(postWidget->sizeHint());
-        // Store PostID in UserRole for selection logic
-        item->setData(Qt::UserRole, QString::fromStdString(p.postID));
-
-        // 7. Assign Widget to Item
-        feedList->setItemWidget(item, postWidget);
-
-        // 8. Connect Inline Buttons
-        // We use lambdas that capture 'p' by value to perform actions on specific posts
-
-        // LIKE BUTTON
-        connect(itemLikeBtn, &QPushButton::clicked, this, [this, p, itemLikeBtn]() {
-            backend.toggleLike(p.postID);
-            int newCount = backend.getLikeCount(p.postID);
-            itemLikeBtn->setText("Like (" + QString::number(newCount) + ")");
-
-            // Refresh detail view if this post happens to be selected
-            if (selectedPostID() == QString::fromStdString(p.postID)) {
-                onPostSelected();
-            }
-        });
-
-        // COMMENT BUTTON
-        connect(itemCommentBtn, &QPushButton::clicked, this, [this, p]() {
-            bool ok;
-            QString text = QInputDialog::getMultiLineText(this, "Add Comment", "Comment on " + QString::fromStdString(p.authorUsername) + "'s post:", "", &ok);
-            if (ok && !text.trimmed().isEmpty()) {
-                backend.addComment(p.postID, text.toStdString());
-                QMessageBox::information(this, "Success", "Comment added.");
-            }
-        });
-
-        // VIEW COMMENTS BUTTON
-        connect(itemViewCommentsBtn, &QPushButton::clicked, this, [this, p]() {
-            vector<Comment> comments = backend.getComments(p.postID);
-            QString all;
-            if (comments.empty()) all = "No comments yet.";
-            else {
-                for (const Comment& c : comments) {
-                    all += QString::fromStdString("[" + c.authorUsername + "]: " + c.content + "\n");
-                }
-            }
-            QMessageBox::information(this, "Comments", all);
-        });
+    if (rankedFeed) {
+        // Ranked view is a single top-k page, so there is nothing to load more
+        for (const RankedPost& rp : backend.getRankedFeed(FEED_PAGE_SIZE)) {
+            addFeedItem(rp.post);
+        }
+    } else {
+        appendFeedPage();
     }
 
     if (feedList->count() == 0) {
@@ -280,6 +240,190 @@ void MainWindow::populateFeed() {
     }
 }
 
+// Fetches the page after feedCursor (Newest First) and appends it to the list
+void MainWindow::appendFeedPage() {
+    FeedPage page = backend.getFeedPage(feedCursor);
+    for (const Post& p : page.posts) {
+        addFeedItem(p);
+    }
+    feedCursor = page.nextCursor;
+    loadMoreBtn->setVisible(!feedCursor.empty());
+}
+
+void MainWindow::onLoadMoreClicked() {
+    if (feedCursor.empty()) return;
+    appendFeedPage();
+}
+
+void MainWindow::onRankedToggled(bool checked) {
+    rankedFeed = checked;
+    populateFeed();
+}
+
+void MainWindow::addFeedItem(const Post& p) {
+    // 1. Create a custom widget to hold the post UI
+    QWidget* postWidget = new QWidget();
+    QVBoxLayout* postLayout = new QVBoxLayout(postWidget);
+    postLayout->setContentsMargins(10, 10, 10, 10);
+
+    // 2. Author Header
+    QLabel* authorLabel = new QLabel("<b>" + QString::fromStdString(p.authorUsername) + "</b>");
+    authorLabel->setStyleSheet("color: #2c3e50; font-size: 14px;");
+    postLayout->addWidget(authorLabel);
+
+    // 3. Post Content
+    QLabel* contentLabel = new QLabel(QString::fromStdString(p.content));
+    contentLabel->setWordWrap(true);
+    contentLabel->setStyleSheet("font-size: 13px; margin-top: 5px; margin-bottom: 5px;");
+    postLayout->addWidget(contentLabel);
+
+    // 4. Action Buttons Layout (Bottom of post)
+    QHBoxLayout* actionLayout = new QHBoxLayout();
+    actionLayout->setContentsMargins(0, 5, 0, 0);
+
+    QPushButton* itemLikeBtn = new QPushButton();
+    itemLikeBtn->setCursor(Qt::PointingHandCursor);
+    likeButtons.insert(p.postID, itemLikeBtn);
+    refreshLikeButton(p.postID);
+
+    QPushButton* itemCommentBtn = new QPushButton("Comment");
+    itemCommentBtn->setCursor(Qt::PointingHandCursor);
+
+    QPushButton* itemViewCommentsBtn = new QPushButton("View Comments");
+    itemViewCommentsBtn->setCursor(Qt::PointingHandCursor);
+
+    actionLayout->addWidget(itemLikeBtn);
+    actionLayout->addWidget(itemCommentBtn);
+    actionLayout->addWidget(itemViewCommentsBtn);
+    actionLayout->addStretch(); // Push buttons to the left
+
+    postLayout->addLayout(actionLayout);
+
+    // 5. Divider Line (Optional visual separation inside the item)
+    QFrame* line = new QFrame();
+    line->setFrameShape(QFrame::HLine);
+    line->setFrameShadow(QFrame::Sunken);
+    postLayout->addWidget(line);
+
+    // 6. Create the List Item
+    QListWidgetItem* item = new QListWidgetItem(feedList);
+    // Important: Set size hint so ListWidget knows how much space to allocate
+    item->setSizeHint(postWidget->sizeHint());
+    // Store PostID in UserRole for selection logic
+    item->setData(Qt::UserRole, QString::fromStdString(p.postID));
+
+    // 7. Assign Widget to Item
+    feedList->setItemWidget(item, postWidget);
+
+    // 8. Connect Inline Buttons
+    // We use lambdas that capture 'p' by value to perform actions on specific posts
+
+    // LIKE BUTTON
+    connect(itemLikeBtn, &QPushButton::clicked, this, [this, p]() {
+        backend.toggleLike(p.postID);
+        refreshLikeButton(p.postID);
+
+        // Refresh detail view if this post happens to be selected
+        if (selectedPostID() == QString::fromStdString(p.postID)) {
+            onPostSelected();
+        }
+    });
+
+    // COMMENT BUTTON
+    connect(itemCommentBtn, &QPushButton::clicked, this, [this, p]() {
+        bool ok;
+        QString text = QInputDialog::getMultiLineText(this, "Add Comment", "Comment on " + QString::fromStdString(p.authorUsername) + "'s post:", "", &ok);
+        if (ok && !text.trimmed().isEmpty()) {
+            backend.addComment(p.postID, text.toStdString());
+            QMessageBox::information(this, "Success", "Comment added.");
+        }
+    });
+
+    // VIEW COMMENTS BUTTON
+    connect(itemViewCommentsBtn, &QPushButton::clicked, this, [this, p]() {
+        showCommentsDialog(p.postID);
+    });
+}
+
+// Top-level comments are read one page at a time ("Load More"); a thread's
+// replies are only fetched when it is expanded
+void MainWindow::showCommentsDialog(const string& postID, const QString& header) {
+    size_t total = backend.getCommentCount(postID);
+    size_t topLevelTotal = backend.getTopLevelCommentCount(postID);
+    QDialog dlg(this);
+    dlg.setWindowTitle("Comments for " + QString::fromStdString(postID));
+    dlg.resize(450, 400);
+    QVBoxLayout* layout = new QVBoxLayout();
+
+    QString summary = total == 0 ? QString("No comments yet.")
+                                 : QString::number(total) + (total == 1 ? " comment" : " comments");
+    layout->addWidget(new QLabel(header.isEmpty() ? summary : header + "\n" + summary));
+    QTreeWidget* tree = new QTreeWidget();
+    tree->setHeaderHidden(true);
+    tree->setWordWrap(true);
+    layout->addWidget(tree);
+    QPushButton* moreBtn = new QPushButton("Load More");
+    QPushButton* replyBtn = new QPushButton("Reply (Selected)");
+    QPushButton* closeBtn = new QPushButton("Close");
+    layout->addWidget(moreBtn);
+    layout->addWidget(replyBtn);
+    layout->addWidget(closeBtn);
+    dlg.setLayout(layout);
+
+    // UserRole holds the comment ID, UserRole + 1 the text without the reply count
+    auto setItemText = [this](QTreeWidgetItem* item) {
+        string cid = item->data(0, Qt::UserRole).toString().toStdString();
+        size_t replies = backend.getReplyCount(cid);
+        QString text = item->data(0, Qt::UserRole + 1).toString();
+        if (replies > 0) text += " (" + QString::number(replies) + (replies == 1 ? " reply)" : " replies)");
+        item->setText(0, text);
+        item->setChildIndicatorPolicy(replies > 0 ? QTreeWidgetItem::ShowIndicator
+                                                  : QTreeWidgetItem::DontShowIndicator);
+    };
+    auto makeItem = [setItemText](const Comment& c) {
+        QTreeWidgetItem* item = new QTreeWidgetItem();
+        item->setData(0, Qt::UserRole, QString::fromStdString(c.commentID));
+        item->setData(0, Qt::UserRole + 1, QString::fromStdString("[" + c.authorUsername + "]: " + c.content));
+        setItemText(item);
+        return item;
+    };
+    auto loadReplies = [this, makeItem](QTreeWidgetItem* item) {
+        string cid = item->data(0, Qt::UserRole).toString().toStdString();
+        for (const Comment& r : backend.getReplies(cid)) item->addChild(makeItem(r));
+    };
+    auto loadPage = [this, postID, topLevelTotal, tree, moreBtn, makeItem]() {
+        size_t offset = static_cast<size_t>(tree->topLevelItemCount());
+        for (const Comment& c : backend.getTopLevelComments(postID, offset, COMMENT_PAGE_SIZE)) {
+            tree->addTopLevelItem(makeItem(c));
+        }
+        moreBtn->setVisible(static_cast<size_t>(tree->topLevelItemCount()) < topLevelTotal);
+    };
+    loadPage();
+
+    connect(tree, &QTreeWidget::itemExpanded, &dlg, [loadReplies](QTreeWidgetItem* item) {
+        if (item->childCount() == 0) loadReplies(item); // first expansion
+    });
+    connect(replyBtn, &QPushButton::clicked, &dlg, [this, &dlg, tree, setItemText, loadReplies]() {
+        QTreeWidgetItem* item = tree->currentItem();
+        if (!item) { QMessageBox::information(&dlg, "Reply", "Select a comment first."); return; }
+        bool ok;
+        QString text = QInputDialog::getMultiLineText(&dlg, "Reply", "Reply:", "", &ok);
+        if (!ok || text.trimmed().isEmpty()) return;
+        if (!backend.addReply(item->data(0, Qt::UserRole).toString().toStdString(), text.toStdString())) {
+            QMessageBox::warning(&dlg, "Reply", "Failed to add reply.");
+            return;
+        }
+        // Reload just this thread's direct replies
+        while (item->childCount() > 0) delete item->child(0);
+        setItemText(item);
+        loadReplies(item);
+        item->setExpanded(true);
+    });
+    connect(moreBtn, &QPushButton::clicked, &dlg, loadPage);
+    connect(closeBtn, &QPushButton::clicked, &dlg, &QDialog::accept);
+    dlg.exec();
+}
+
 void MainWindow::onLoginClicked() {
     string u = usernameEdit->text().toStdString();
     string p = passwordEdit->text().toStdString();
@@ -327,14 +471,12 @@ void MainWindow::onPostSelected() {
     QString postID = selectedPostID();
     if (postID.isEmpty()) { postDetailLabel->clear(); return; }
 
-    vector<Post> posts = backend.getAllPosts();
-    for (const Post& p : posts) {
-        if (QString::fromStdString(p.postID) == postID) {
-            postDetailLabel->setText(QString::fromStdString(backend.postSummary(p)));
-            return;
-        }
+    PostView view;
+    if (backend.getPostView(postID.toStdString(), view)) {
+        postDetailLabel->setText(QString::fromStdString(backend.postSummary(view)));
+    } else {
+        postDetailLabel->setText("Post not found.");
     }
-    postDetailLabel->setText("Post not found.");
 }
 
 // Legacy slot for the right-hand panel button
@@ -344,7 +486,7 @@ void MainWindow::onLikeClicked() {
     if (backend.toggleLike(postID.toStdString())) {
         QMessageBox::information(this, "Like", "Toggled like for " + postID);
         onPostSelected(); // Refresh details
-        populateFeed(); // Refresh list buttons
+        refreshLikeButton(postID.toStdString());
     } else {
         QMessageBox::warning(this, "Like", "Action failed.");
     }
@@ -369,16 +511,7 @@ void MainWindow::onAddCommentClicked() {
 void MainWindow::onViewCommentsClicked() {
     QString postID = selectedPostID();
     if (postID.isEmpty()) { QMessageBox::information(this, "Comments", "Select a post first."); return; }
-    vector<Comment> comments = backend.getComments(postID.toStdString());
-    if (comments.empty()) {
-        QMessageBox::information(this, "Comments", "No comments yet.");
-        return;
-    }
-    QString all;
-    for (const Comment& c : comments) {
-        all += QString::fromStdString("[" + c.authorUsername + "]: " + c.content + "\n");
-    }
-    QMessageBox::information(this, "Comments for " + postID, all);
+    showCommentsDialog(postID.toStdString());
 }
 
 void MainWindow::onAddFriendClicked() {
@@ -395,7 +528,16 @@ void MainWindow::onAddFriendClicked() {
 }
 
 void MainWindow::onSuggestFriendsClicked() {
-    vector<string> suggestions = backend.suggestFriends();
+    vector<FriendSuggestion> suggestions = backend.getFriendSuggestions();
+    // Sparse users have few second-degree contacts; top up from random walks
+    if (suggestions.size() < SUGGESTION_LIMIT) {
+        for (const FriendSuggestion& rec : backend.getRecommendations()) {
+            if (suggestions.size() == SUGGESTION_LIMIT) break;
+            bool listed = false;
+            for (const FriendSuggestion& s : suggestions) if (s.username == rec.username) listed = true;
+            if (!listed) suggestions.push_back(rec);
+        }
+    }
     if (suggestions.empty()) {
         QMessageBox::information(this, "Suggestions", "No suggestions right now.");
         return;
@@ -409,12 +551,16 @@ void MainWindow::onSuggestFriendsClicked() {
 
     QListWidget* listWidget = new QListWidget();
 
-    for (const string& s : suggestions) {
+    for (const FriendSuggestion& suggestion : suggestions) {
+        const string s = suggestion.username;
         QWidget* itemWidget = new QWidget();
         QHBoxLayout* itemLayout = new QHBoxLayout(itemWidget);
         itemLayout->setContentsMargins(5, 5, 5, 5);
 
-        QLabel* nameLabel = new QLabel(QString::fromStdString(s));
+        QString mutual = suggestion.mutualFriends == 0 ? QString("Recommended for you")
+                         : QString::number(suggestion.mutualFriends)
+                           + (suggestion.mutualFriends == 1 ? " mutual friend" : " mutual friends");
+        QLabel* nameLabel = new QLabel(QString::fromStdString(s) + "\n" + mutual);
         QPushButton* addBtn = new QPushButton("Add Friend");
 
         itemLayout->addWidget(nameLabel);
@@ -451,7 +597,22 @@ void MainWindow::onSearchUserClicked() {
     if (ok && !uname.trimmed().isEmpty()) {
         User u;
         if (backend.searchUser(uname.toStdString(), u)) {
-            QMessageBox::information(this, "User Found", "Username: " + QString::fromStdString(u.username) + "\nID: " + QString::fromStdString(u.userID));
+            QString info = "Username: " + QString::fromStdString(u.username) + "\nID: " + QString::fromStdString(u.userID);
+            if (u.username != backend.currentUsername()) {
+                info += "\nMutual friends: " + QString::number(backend.getMutualFriendCount(u.username));
+                vector<string> path;
+                if (backend.getConnectionPath(u.username, path)) {
+                    QString chain;
+                    for (size_t i = 0; i < path.size(); ++i) {
+                        chain += (i == 0 ? QString("You") : QString::fromStdString(path[i]));
+                        if (i + 1 < path.size()) chain += " -> ";
+                    }
+                    info += "\nConnection (" + QString::number(path.size() - 1) + " hops): " + chain;
+                } else {
+                    info += "\nNot connected within " + QString::number(SEPARATION_MAX_DEPTH) + " hops";
+                }
+            }
+            QMessageBox::information(this, "User Found", info);
         } else {
             QMessageBox::information(this, "Search", "User not found.");
         }
@@ -476,6 +637,14 @@ void MainWindow::onMyProfileClicked() {
         myPostsList->addItem(it);
     }
 
+    // As of the last background build; nothing is shown before the first
+    double reach2 = 0, reach3 = 0;
+    if (backend.getReachEstimate(backend.currentUsername(), 2, reach2)
+        && backend.getReachEstimate(backend.currentUsername(), 3, reach3)) {
+        dlgLayout->addWidget(new QLabel(QString("Your posts can reach ~%1 people within 2 hops (~%2 within 3).")
+                                            .arg(qRound(reach2)).arg(qRound(reach3))));
+    }
+
     dlgLayout->addWidget(new QLabel("Select a post to edit, delete, or view likes/comments:"));
     dlgLayout->addWidget(myPostsList);
 
@@ -502,11 +671,8 @@ void MainWindow::onMyProfileClicked() {
         if (sel.empty()) { QMessageBox::information(this, "Edit", "Select a post first."); return; }
         QString pid = sel.first()->data(Qt::UserRole).toString();
 
-        vector<Post> posts = backend.getPostsByUser(backend.currentUsername());
-        QString original;
-        for (const Post& p : posts) {
-            if (QString::fromStdString(p.postID) == pid) { original = QString::fromStdString(p.content); break; }
-        }
+        const Post* post = backend.getPost(pid.toStdString());
+        QString original = post ? QString::fromStdString(post->content) : QString();
         bool ok;
         QString newContent = QInputDialog::getMultiLineText(this, "Edit Post", "Content:", original, &ok);
         if (ok && !newContent.trimmed().isEmpty()) {
@@ -549,13 +715,7 @@ void MainWindow::onMyProfileClicked() {
         if (sel.empty()) { QMessageBox::information(this, "View", "Select a post first."); return; }
         QString pid = sel.first()->data(Qt::UserRole).toString();
         int likes = backend.getLikeCount(pid.toStdString());
-        vector<Comment> comments = backend.getComments(pid.toStdString());
-        QString out = QString::number(likes) + " likes\n\n";
-        if (comments.empty()) out += "No comments.";
-        else {
-            for (const Comment& c : comments) out += QString::fromStdString("[" + c.authorUsername + "]: " + c.content + "\n");
-        }
-        QMessageBox::information(this, "Likes & Comments for " + pid, out);
+        showCommentsDialog(pid.toStdString(), QString::number(likes) + " likes");
     });
 
     connect(closeBtn, &QPushButton::clicked, &dlg, &QDialog::accept);
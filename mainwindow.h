@@ -12,6 +12,7 @@
 #include <QHBoxLayout>
 #include <QSplitter>
 #include <QStackedWidget>
+#include <QTimer>
 
 #include "backend_social_media.h"
 
@@ -30,6 +31,8 @@ private slots:
     void onLikeClicked();
     void onAddCommentClicked();
     void onViewCommentsClicked();
+    void onLoadMoreClicked();
+    void onRankedToggled(bool checked);
     void onAddFriendClicked();
     void onSuggestFriendsClicked();
     void onSearchUserClicked();
@@ -54,7 +57,9 @@ private:
 
     // Main App widgets (Page 2)
     QPushButton* logoutBtn;
+    QPushButton* rankedToggleBtn;
     QListWidget* feedList;
+    QPushButton* loadMoreBtn;
     QLabel* postDetailLabel;
     QPushButton* likeBtn;
     QPushButton* addCommentBtn;
@@ -67,10 +72,28 @@ private:
     QPushButton* searchUserBtn;
     QPushButton* myProfileBtn;
 
+    // Feed paging state: cursor for the next page, empty when exhausted
+    string feedCursor;
+    bool rankedFeed = false; // "Top Posts" ranking instead of newest first
+
+    // Drives the backend's like batching; feed like buttons by post ID so a
+    // flushed count updates one label instead of rebuilding the feed
+    QTimer* likeFlushTimer;
+    SimpleHashTable<string, QPushButton*> likeButtons;
+    // Closes the write-ahead log's group-commit window while the app idles
+    QTimer* walSyncTimer;
+    bool walSyncFailing = false; // warned once until a sync succeeds again
+    // Collects and restarts the backend's background reach rebuilds
+    QTimer* reachRefreshTimer;
+
     // Helper functions
     void populateFeed();
+    void appendFeedPage();
+    void addFeedItem(const Post& p);
+    void refreshLikeButton(const string& postID);
     QString selectedPostID() const;
     void showFriendsDialog();
+    void showCommentsDialog(const string& postID, const QString& header = QString());
 };
 
 #endif // MAINWINDOW_H